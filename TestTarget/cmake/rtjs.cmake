@@ -1,6 +1,85 @@
+set(RTJS_RUNTIME_DIR "${CMAKE_CURRENT_LIST_DIR}/../../runtime" CACHE PATH "Directory of the rtjs runtime headers")
+
+# generation goes through an "rtjsgen --daemon <socket>" listening here, if one runs (in-process otherwise)
+set(RTJS_DAEMON_SOCKET "${CMAKE_BINARY_DIR}/rtjsgen.sock" CACHE FILEPATH "Socket of the rtjsgen daemon, empty to never use one")
+
+# RTJS_PGO_INSTRUMENT: the profile directory, only set in the instrumented build RtjsTarget(... PGO) configures
+
+
+# RtjsTarget(<target> [ASYNC <functions ...>] [FILES <globs ...>] [NAMESPACES <namespaces ...>]
+#            [EXCLUDE <name globs ...>] [EXPORT_ONLY] [PCH <headers ...>] [TABLE] [AUDIT]
+#            [VALIDATION debug|checked|trusted] [STREAM]
+#            [LTO] [PGO <training script> [PGO_ARGS <arguments ...>]])
+#   ASYNC: functions to run on the worker pool, returning a promise (same as [[rtjs::async]])
+#   FILES: only parse the headers matching these globs
+#   NAMESPACES: only bind entities in these namespaces (nested ones included)
+#   EXCLUDE: never bind entities whose (qualified) name matches these globs (same as [[rtjs::ignore]])
+#   EXPORT_ONLY: only bind entities marked [[rtjs::export]], or members of such classes / namespaces
+#   PCH: prefix headers precompiled once and reused for every parsed header,
+#        the target's own PRECOMPILE_HEADERS if not given
+#   TABLE: bind functions through a constexpr descriptor table and rtjs/bindings.h,
+#          one trampoline per signature instead of one handler per function
+#   AUDIT: count the engine values every binding creates and releases, report leaks at exit (rtjs/audit.h),
+#          all functions get generated handlers then (no TABLE)
+#   VALIDATION: argument checks of the handlers, for bindings without [[rtjs::validation(level)]]:
+#               debug: count, types and integer ranges with descriptive errors, checked (default): count
+#               and type tags, trusted: none, for first-party scripts only
+#   STREAM: for very large header sets, each header is released once its bindings are generated and
+#           the handlers are spooled to disk, peak memory is that of the largest header
+#   LTO: link time optimization over the generated bindings, the target's sources and jerry-core /
+#        jerry-port-default when JerryScript is built from source in the same project, so bound
+#        functions can be inlined into their handlers
+#   PGO: profile guided optimization. the project is configured and built once more instrumented
+#        (in rtjs-pgo-<target> below the binary dir), the instrumented target is run with PGO_ARGS and
+#        the training script, and the target is then compiled with the profile. needs clang
+#        (with llvm-profdata) or gcc 13+, and an executable target
 macro(RtjsTarget target)
   set(cppast_target ${target})
 
+  cmake_parse_arguments(RTJS "EXPORT_ONLY;TABLE;AUDIT;LTO;STREAM" "PGO;VALIDATION" "ASYNC;FILES;NAMESPACES;EXCLUDE;PCH;PGO_ARGS" ${ARGN})
+
+  set(rtjs_args)
+  if(RTJS_DAEMON_SOCKET)
+    list(APPEND rtjs_args "--server" "${RTJS_DAEMON_SOCKET}")
+  endif()
+  if(RTJS_ASYNC)
+    string(REPLACE ";" "," rtjs_async "${RTJS_ASYNC}")
+    list(APPEND rtjs_args "-A" "${rtjs_async}")
+  endif()
+  if(RTJS_FILES)
+    string(REPLACE ";" "," rtjs_files "${RTJS_FILES}")
+    list(APPEND rtjs_args "-F" "${rtjs_files}")
+  endif()
+  if(RTJS_NAMESPACES)
+    string(REPLACE ";" "," rtjs_namespaces "${RTJS_NAMESPACES}")
+    list(APPEND rtjs_args "-N" "${rtjs_namespaces}")
+  endif()
+  if(RTJS_EXCLUDE)
+    string(REPLACE ";" "," rtjs_exclude "${RTJS_EXCLUDE}")
+    list(APPEND rtjs_args "-X" "${rtjs_exclude}")
+  endif()
+  if(RTJS_EXPORT_ONLY)
+    list(APPEND rtjs_args "--export-only")
+  endif()
+  if(RTJS_AUDIT)
+    list(APPEND rtjs_args "--audit")
+  endif()
+  if(RTJS_TABLE)
+    list(APPEND rtjs_args "--table")
+  endif()
+  if(RTJS_STREAM)
+    list(APPEND rtjs_args "--stream")
+  endif()
+  if(RTJS_VALIDATION)
+    list(APPEND rtjs_args "--validation" "${RTJS_VALIDATION}")
+  endif()
+  if(RTJS_PCH)
+    string(REPLACE ";" "," rtjs_pch "${RTJS_PCH}")
+    list(APPEND rtjs_args "--pch" "${rtjs_pch}")
+  else()
+    list(APPEND rtjs_args "--pch" "$<TARGET_PROPERTY:${target},PRECOMPILE_HEADERS>")
+  endif()
+
   get_target_property(cppast_sources ${cppast_target} SOURCES)
   #message(STATUS "SOURCES for ${cppast_target} = ${cppast_sources}")
 
@@ -8,7 +87,7 @@ macro(RtjsTarget target)
 
   add_custom_command(
     OUTPUT "rtjs_${cppast_target}.cpp"
-    COMMAND rtjsgen ${cppast_sources} "-I" $<TARGET_PROPERTY:${cppast_target},INCLUDE_DIRECTORIES> "-D" $<TARGET_PROPERTY:${cppast_target},COMPILE_DEFINITIONS> "-O" ${output}
+    COMMAND rtjsgen ${cppast_sources} "-I" $<TARGET_PROPERTY:${cppast_target},INCLUDE_DIRECTORIES> "-D" $<TARGET_PROPERTY:${cppast_target},COMPILE_DEFINITIONS> "-O" ${output} ${rtjs_args}
     #COMMAND "echo" ${cppast_sources} "-I" $<TARGET_PROPERTY:${cppast_target},INCLUDE_DIRECTORIES> "-D" $<TARGET_PROPERTY:${cppast_target},COMPILE_DEFINITIONS> "-O" ${output}
     #COMMAND ...  "-I$<JOIN:$<TARGET_PROPERTY:${cppast_target},INCLUDE_DIRECTORIES>, -I>"
     WORKING_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}"
@@ -22,6 +101,166 @@ macro(RtjsTarget target)
   )
 
   target_sources(${cppast_target} PRIVATE ${output})
-  target_compile_definitions(${cppast_target} PRIVATE RTJS_INIT=__rtjs_init_${cppast_target})
+  target_include_directories(${cppast_target} PRIVATE ${RTJS_RUNTIME_DIR})
+  target_compile_definitions(${cppast_target} PRIVATE
+    RTJS_INIT=__rtjs_init_${cppast_target}
+    RTJS_CLEANUP=__rtjs_cleanup_${cppast_target}
+  )
   add_dependencies(${cppast_target} rtjs_${cppast_target})
+
+  if(RTJS_LTO)
+    rtjs_lto(${cppast_target})
+  endif()
+  # the instrumented build instruments every target, it is configured without the options asking for PGO
+  if(RTJS_PGO_INSTRUMENT)
+    rtjs_pgo_instrument(${cppast_target})
+  elseif(RTJS_PGO)
+    rtjs_pgo(${cppast_target} "${RTJS_PGO}" ${RTJS_PGO_ARGS})
+  endif()
 endmacro()
+
+
+# interprocedural optimization for target and the JerryScript libraries, if they are built here
+function(rtjs_lto target)
+  include(CheckIPOSupported)
+  check_ipo_supported(RESULT rtjs_ipo OUTPUT rtjs_ipo_error)
+  if(NOT rtjs_ipo)
+    message(WARNING "RtjsTarget(${target} LTO): not supported by this toolchain (${rtjs_ipo_error})")
+    return()
+  endif()
+
+  foreach(lto_target ${target} jerry-core jerry-port-default)
+    if(TARGET ${lto_target})
+      set_property(TARGET ${lto_target} PROPERTY INTERPROCEDURAL_OPTIMIZATION TRUE)
+    endif()
+  endforeach()
+endfunction()
+
+
+# whether the compiler can do PGO
+function(rtjs_pgo_supported result)
+  if(CMAKE_CXX_COMPILER_ID MATCHES "Clang"
+     OR (CMAKE_CXX_COMPILER_ID STREQUAL "GNU" AND NOT CMAKE_CXX_COMPILER_VERSION VERSION_LESS 13))
+    set(${result} TRUE PARENT_SCOPE)
+  else()
+    set(${result} FALSE PARENT_SCOPE)
+  endif()
+endfunction()
+
+
+# target and the JerryScript libraries, if they are built here
+function(rtjs_pgo_targets target result)
+  set(pgo_targets ${target})
+  foreach(jerry_target jerry-core jerry-port-default)
+    if(TARGET ${jerry_target})
+      list(APPEND pgo_targets ${jerry_target})
+    endif()
+  endforeach()
+  set(${result} ${pgo_targets} PARENT_SCOPE)
+endfunction()
+
+
+# the instrumented build only collects, into RTJS_PGO_INSTRUMENT
+function(rtjs_pgo_instrument target)
+  rtjs_pgo_supported(supported)
+  if(NOT supported)
+    return()
+  endif()
+
+  if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+    set(instrument_flags "-fprofile-instr-generate")
+  else()
+    # profiles are found by object path, relative to the binary dir they are the same in both builds
+    set(instrument_flags "-fprofile-generate=${RTJS_PGO_INSTRUMENT}" "-fprofile-update=atomic" "-fprofile-prefix-path=${CMAKE_BINARY_DIR}")
+  endif()
+
+  rtjs_pgo_targets(${target} pgo_targets)
+  foreach(pgo_target ${pgo_targets})
+    target_compile_options(${pgo_target} PRIVATE ${instrument_flags})
+  endforeach()
+  target_link_options(${target} PRIVATE ${instrument_flags})
+endfunction()
+
+
+function(rtjs_pgo target script)
+  get_filename_component(script "${script}" ABSOLUTE)
+
+  rtjs_pgo_supported(supported)
+  if(NOT supported)
+    message(WARNING "RtjsTarget(${target} PGO): needs clang or gcc 13+, building without profile")
+    return()
+  endif()
+
+  rtjs_pgo_targets(${target} pgo_targets)
+
+  set(pgo_dir "${CMAKE_BINARY_DIR}/rtjs-pgo-${target}")
+  set(profile_dir "${pgo_dir}/profile")
+  set(instrumented "${pgo_dir}/bin/${target}${CMAKE_EXECUTABLE_SUFFIX}")
+
+  if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+    get_filename_component(compiler_dir "${CMAKE_CXX_COMPILER}" DIRECTORY)
+    find_program(RTJS_LLVM_PROFDATA NAMES llvm-profdata HINTS "${compiler_dir}")
+    if(NOT RTJS_LLVM_PROFDATA)
+      message(WARNING "RtjsTarget(${target} PGO): llvm-profdata not found, building without profile")
+      return()
+    endif()
+
+    set(profile "${profile_dir}/${target}.profdata")
+    set(train_env "LLVM_PROFILE_FILE=${profile_dir}/${target}.profraw")
+    set(merge_command COMMAND "${RTJS_LLVM_PROFDATA}" merge "-output=${profile}" "${profile_dir}/${target}.profraw")
+    set(use_flags "-fprofile-instr-use=${profile}" "-Wno-profile-instr-unprofiled" "-Wno-profile-instr-out-of-date")
+  else()
+    set(profile "${profile_dir}/${target}.stamp")
+    set(train_env)
+    set(merge_command COMMAND "${CMAKE_COMMAND}" -E touch "${profile}")
+    set(use_flags "-fprofile-use=${profile_dir}" "-fprofile-partial-training" "-fprofile-prefix-path=${CMAKE_BINARY_DIR}" "-Wno-missing-profile")
+  endif()
+
+  get_target_property(sources ${target} SOURCES)
+
+  add_custom_command(
+    OUTPUT "${profile}"
+    COMMAND "${CMAKE_COMMAND}" -E remove_directory "${profile_dir}"
+    COMMAND "${CMAKE_COMMAND}" -S "${CMAKE_SOURCE_DIR}" -B "${pgo_dir}/build" -G "${CMAKE_GENERATOR}"
+            "-DCMAKE_BUILD_TYPE=${CMAKE_BUILD_TYPE}"
+            "-DCMAKE_C_COMPILER=${CMAKE_C_COMPILER}"
+            "-DCMAKE_CXX_COMPILER=${CMAKE_CXX_COMPILER}"
+            "-DCMAKE_RUNTIME_OUTPUT_DIRECTORY=${pgo_dir}/bin"
+            "-DRTJS_PGO_INSTRUMENT=${profile_dir}"
+            "-DRTJS_DAEMON_SOCKET=${RTJS_DAEMON_SOCKET}"
+    COMMAND "${CMAKE_COMMAND}" --build "${pgo_dir}/build" --target ${target}
+    COMMAND "${CMAKE_COMMAND}" -E env ${train_env} "${instrumented}" ${ARGN} "${script}"
+    ${merge_command}
+    DEPENDS "${script}" ${sources}
+    COMMENT "Training ${target} with ${script}"
+    VERBATIM
+  )
+
+  add_custom_target(rtjs_pgo_${target} DEPENDS "${profile}")
+  add_dependencies(rtjs_pgo_${target} rtjs_${target}) # generates the bindings only once
+  add_dependencies(${target} rtjs_pgo_${target})
+
+  # recompile with every new profile
+  set_property(SOURCE ${sources} APPEND PROPERTY OBJECT_DEPENDS "${profile}")
+
+  foreach(pgo_target ${pgo_targets})
+    target_compile_options(${pgo_target} PRIVATE ${use_flags})
+    if(NOT pgo_target STREQUAL target)
+      add_dependencies(${pgo_target} rtjs_pgo_${target})
+
+      # the sources of the libraries belong to another directory, only cmake 3.18+ sets properties there
+      if(CMAKE_VERSION VERSION_LESS 3.18)
+        message(WARNING "RtjsTarget(${target} PGO): ${pgo_target} is not rebuilt with a new profile before cmake 3.18")
+      else()
+        get_target_property(pgo_sources ${pgo_target} SOURCES)
+        get_target_property(pgo_source_dir ${pgo_target} SOURCE_DIR)
+        set(pgo_paths)
+        foreach(pgo_source ${pgo_sources})
+          get_filename_component(pgo_source "${pgo_source}" ABSOLUTE BASE_DIR "${pgo_source_dir}")
+          list(APPEND pgo_paths "${pgo_source}")
+        endforeach()
+        set_property(SOURCE ${pgo_paths} TARGET_DIRECTORY ${pgo_target} APPEND PROPERTY OBJECT_DEPENDS "${profile}")
+      endif()
+    endif()
+  endforeach()
+endfunction()
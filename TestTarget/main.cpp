@@ -1,9 +1,20 @@
 #include "x.h"
 
 #include <cstring>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+
+#include <unistd.h>
 
 #include <jerryscript.h>
+#include <rtjs/budget.h>
+#include <rtjs/callbacks.h>
+#include <rtjs/eventloop.h>
+#include <rtjs/heap.h>
+#include <rtjs/scriptcache.h>
+#include <rtjs/snapshot.h>
+#include <rtjs/soak.h>
 
 
 using namespace std;
@@ -206,19 +217,212 @@ void print_unhandled_exception(jerry_value_t error_value, uint8_t *buffer)
 } /* print_unhandled_exception */
 
 
+static void evalLine(rtjs::ScriptCache &cache, rtjs::ExecutionBudget &budget, const std::string &x)
+{
+  jerry_value_t r;
+
+  try
+  {
+    rtjs::ExecutionBudget::Scope scope(budget, 2000000000ull); // 2s per console line
+    r = cache.run(x); // not strict, like the jerry_eval() it replaces
+  }
+  catch (const std::string &msg)
+  {
+    cerr << "JS exception: " << msg << endl;
+    return;
+  }
+
+  auto et = jerry_get_error_type(r);
+
+  if (et != JERRY_ERROR_NONE)
+  {
+    auto y = jerry_get_value_from_error(r, true);
+    print_unhandled_exception(y, (uint8_t *)x.c_str());
+    jerry_release_value(y);
+    return;
+  }
+
+
+  auto rt = jerry_value_get_type(r);
+
+  std::string result;
+  switch (rt)
+  {
+    case JERRY_TYPE_NONE:
+    {
+      result = "(NONE)";
+      break;
+    }
+
+    case JERRY_TYPE_UNDEFINED:
+    {
+      result = "(undefined)";
+      break;
+    }
+
+    case JERRY_TYPE_NULL:
+    {
+      result = "(null)";
+      break;
+    }
+
+    case JERRY_TYPE_BOOLEAN:
+    {
+      result = jerry_get_boolean_value(r) ? "true" : "false";
+      break;
+    }
+
+    case JERRY_TYPE_NUMBER:
+    {
+      result = to_string(jerry_get_number_value(r));
+      break;
+    }
+
+    case JERRY_TYPE_STRING:
+    {
+      result.resize(jerry_get_utf8_string_size(r));
+      jerry_string_to_utf8_char_buffer(r, (jerry_char_t *)&result[0], (jerry_size_t)result.size());
+      break;
+    }
+
+    case JERRY_TYPE_OBJECT:
+    {
+      result = "[object]";
+      break;
+    }
+
+    case JERRY_TYPE_FUNCTION:
+    {
+      result = "[f]";
+      break;
+    }
+
+    case JERRY_TYPE_ERROR:
+    {
+      result = "(error)";
+      break;
+    }
+
+    case JERRY_TYPE_SYMBOL:
+    {
+      result = "(symbol)";
+      break;
+    }
+  }
+
+  jerry_release_value(r);
+  cerr << result << endl;
+}
+
+
 extern void RTJS_INIT();
+extern void RTJS_CLEANUP();
 
 
-int main()
+// TestTarget --soak [iterations]: every binding in a loop, fails if the heap grows
+static int soakBindings(unsigned long iterations)
 {
-  std::cerr << "main" << std::endl;
+  static const char *bindings[] =
+  {
+    "x(false)",
+    "filter('Linear')",
+    "steeper('LowPass')",
+    "scale({ x: 1, y: 2 }, 2)",
+    "origin().x",
+    "flip({ x: 1, y: 2 }).x",
+    "normalize([1, 2, 3])",
+    "histogram(['Nearest', 'Linear', 'Linear'])",
+    "ramp(1000).get(500)",
+    "filterIds().values().next()",
+    "version()",
+    "describe({ x: 1, y: 2 })",
+    "forEachSample(4, function(i, v) {})",
+    "repeat(3, function(i) {})",
+    "startTicking(function(i) {}), tick(), stopTicking()",
+    "TestClass.static_test()",
+    "tools_Named.ctor0().length()",
+  };
+
+  int failed = 0;
+  for (const char *binding : bindings)
+    failed += !rtjs::soak(binding, iterations);
+
+  return failed ? 1 : 0;
+}
 
-  RTJS_INIT();
+
+// runs a script file through the bindings, e.g. the PGO training run (RtjsTarget PGO)
+static int runScript(const char *path)
+{
+  std::ifstream file(path);
+  if (!file)
+  {
+    std::cerr << "cannot read " << path << std::endl;
+    return -1;
+  }
+
+  std::stringstream source;
+  source << file.rdbuf();
+  const std::string script(source.str());
+
+  jerry_value_t result = jerry_eval((const jerry_char_t *)script.data(), script.size(), JERRY_PARSE_NO_OPTS);
+  if (!jerry_value_is_error(result))
+  {
+    jerry_release_value(result);
+    result = jerry_run_all_enqueued_jobs();
+  }
+
+  if (jerry_value_is_error(result))
+  {
+    jerry_value_t error = jerry_get_value_from_error(result, true);
+    print_unhandled_exception(error, (uint8_t *)"");
+    jerry_release_value(error);
+    return -1;
+  }
+
+  jerry_release_value(result);
+  return 0;
+}
+
+
+// everything between the init and the cleanup of the engine, bundle stays mapped until jerry_cleanup()
+static int run(int argc, char **argv, rtjs::MappedSnapshot &bundle)
+{
+  rtjs::setCallbackErrorHandler([](jerry_value_t error) { print_unhandled_exception(error, (uint8_t *)""); });
+
+  if (argc > 1 && std::string(argv[1]) == "--soak")
+    return soakBindings(argc > 2 ? std::stoul(argv[2]) : 1000000);
+
+  if (argc > 2 && std::string(argv[1]) == "--run")
+    return runScript(argv[2]);
+
+  // TestTarget [snapshot]: run a (static) snapshot bundle in place before the console
+  if (argc > 1)
+  {
+    if (!bundle.open(argv[1]))
+    {
+      std::cerr << "cannot map snapshot " << argv[1] << std::endl;
+      return -1;
+    }
+
+    jerry_value_t result = bundle.exec();
+    if (jerry_value_is_error(result))
+    {
+      jerry_value_t error = jerry_get_value_from_error(result, true);
+      print_unhandled_exception(error, (uint8_t *)"");
+      jerry_release_value(error);
+      return -1;
+    }
+    jerry_release_value(result);
+  }
 
   auto globObj = jerry_get_global_object();
   jerry_value_t boolptrfn = jerry_create_external_function(boolptrHandler);
   jerry_value_t boolptrfnName= jerry_create_string((const jerry_char_t *)"createBoolPointer");
-  jerry_set_property(globObj, boolptrfnName, boolptrfn);
+  jerry_release_value(jerry_set_property(globObj, boolptrfnName, boolptrfn));
+  jerry_release_value(boolptrfnName);
+  jerry_release_value(boolptrfn);
+  jerry_release_value(globObj);
 
 
   {
@@ -226,6 +430,7 @@ int main()
     jerry_value_t eval = jerry_eval((const jerry_char_t *)test, std::strlen(test), 0);
 
     jerry_error_t err = jerry_get_error_type(eval);
+    jerry_release_value(eval);
     if (err != JERRY_ERROR_NONE)
     {
       std::cerr << ":( #1" << std::endl;
@@ -241,6 +446,7 @@ int main()
     jerry_value_t eval = jerry_eval((const jerry_char_t *)test, std::strlen(test), 0);
 
     jerry_error_t err = jerry_get_error_type(eval);
+    jerry_release_value(eval);
     if (err != JERRY_ERROR_NONE)
     {
       std::cerr << ":( #2" << std::endl;
@@ -254,112 +460,72 @@ int main()
   cerr << "TestTarget console" << endl << endl;
 
 
-  while (true)
-  {
-    cerr << "> ";
-
-    std::string x;
-    std::getline(std::cin, x);
-
-    if (x == "exit")
-      return 0;
-
-    jerry_value_t r;
+  rtjs::EventLoop loop;
+  loop.registerBindings();
+  loop.attachWorkerPool(rtjs::WorkerPool::instance()); // settle promises of finished async calls
+  loop.setErrorHandler([](jerry_value_t error) { print_unhandled_exception(error, (uint8_t *)""); });
 
-    try
-    {
-      r = jerry_eval((const jerry_char_t *)x.c_str(), x.length(), JERRY_PARSE_STRICT_MODE);
-    }
-    catch (const std::string &msg)
-    {
-      cerr << "JS exception: " << msg << endl;
-    }
-
-    auto et = jerry_get_error_type(r);
-
-    if (et != JERRY_ERROR_NONE)
+  // collect between console lines rather than in the middle of one, report when the heap gets tight
+  rtjs::HeapMonitor heap;
+  heap.registerBindings();
+  heap.setCollectAbove(heap.usage().mSize / 2);
+  heap.addThreshold(heap.usage().mSize * 3 / 4, [](const rtjs::HeapMonitor::Usage &usage, bool above)
+  {
+    cerr << "heap " << (above ? "above" : "back below") << " 75%: " << usage.mAllocated << " of " << usage.mSize << " bytes" << endl;
+  });
+  loop.setIdleHandler([&heap]() { heap.idle(); });
+
+  rtjs::ScriptCache cache;
+  rtjs::ExecutionBudget budget;
+  std::string input;
+  loop.watchFd(STDIN_FILENO, EPOLLIN, [&loop, &cache, &budget, &input](uint32_t)
+  {
+    char buf[4096];
+    ssize_t count = read(STDIN_FILENO, buf, sizeof(buf));
+    if (count <= 0)
     {
-      auto y = jerry_get_value_from_error(r, true);
-      print_unhandled_exception(y, (uint8_t *)x.c_str());
-      continue;
+      loop.stop();
+      return;
     }
 
+    input.append(buf, count);
 
-    auto rt = jerry_value_get_type(r);
-
-    std::string result;
-    switch (rt)
+    size_t newline;
+    while ((newline = input.find('\n')) != std::string::npos)
     {
-      case JERRY_TYPE_NONE:
-      {
-        result = "(NONE)";
-        break;
-      }
-
-      case JERRY_TYPE_UNDEFINED:
-      {
-        result = "(undefined)";
-        break;
-      }
-
-      case JERRY_TYPE_NULL:
-      {
-        result = "(null)";
-        break;
-      }
-
-      case JERRY_TYPE_BOOLEAN:
-      {
-        result = jerry_get_boolean_value(r) ? "true" : "false";
-        break;
-      }
+      std::string x(input, 0, newline);
+      input.erase(0, newline + 1);
 
-      case JERRY_TYPE_NUMBER:
+      if (x == "exit")
       {
-        result = to_string(jerry_get_number_value(r));
-        break;
+        loop.stop();
+        return;
       }
 
-      case JERRY_TYPE_STRING:
-      {
-        auto strsize = jerry_get_utf8_string_size(r);
-        jerry_char_t *buf = (jerry_char_t *)malloc(strsize);
-        jerry_string_to_utf8_char_buffer(r, buf, strsize);
-        free(buf);
+      evalLine(cache, budget, x);
+      cerr << "> ";
+    }
+  });
 
-        result = std::string((const char *)buf);
-        break;
-      }
+  cerr << "> ";
+  loop.run();
 
-      case JERRY_TYPE_OBJECT:
-      {
-        result = "[object]";
-        break;
-      }
+  return 0;
+}
 
-      case JERRY_TYPE_FUNCTION:
-      {
-        result = "[f]";
-        break;
-      }
 
-      case JERRY_TYPE_ERROR:
-      {
-        result = "(error)";
-        break;
-      }
+int main(int argc, char **argv)
+{
+  std::cerr << "main" << std::endl;
 
-      case JERRY_TYPE_SYMBOL:
-      {
-        result = "(symbol)";
-        break;
-      }
-    }
+  RTJS_INIT();
 
-    cerr << result << endl;
-  }
+  rtjs::MappedSnapshot bundle;
+  const int result = run(argc, argv, bundle);
 
-  return 0;
+  RTJS_CLEANUP();
+  jerry_cleanup();
+  return result;
 }
 
 
@@ -0,0 +1,18 @@
+// typical use of the hottest bindings, run by the instrumented build with TESTTARGET_OPTIMIZE (see CMakeLists.txt)
+for (var i = 0; i < 200000; i++)
+{
+  x(i % 2 == 0);
+  filter(i % 3 == 0 ? 'Nearest' : 'Linear');
+  scale({ x: i, y: 2 }, 0.5);
+  origin().x += 1;
+  version();
+}
+
+for (var i = 0; i < 20000; i++)
+{
+  normalize([1, 2, i]);
+  histogram(['Nearest', 'Linear', 'Linear']);
+  ramp(1000).get(i % 1000);
+  forEachSample(8, function(i, v) {});
+  describe({ x: i, y: 1 });
+}
@@ -1,6 +1,12 @@
 #include "x.h"
 
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream> // .......
+#include <thread>
+
+#include <rtjs/callbacks.h>
 
 
 bool x(bool y)
@@ -17,6 +23,142 @@ bool *x2(bool *y)
 }
 
 
+Filter filter(Filter f)
+{
+  std::cerr << "filter called" << std::endl;
+  return f;
+}
+
+
+audio::Filter steeper(audio::Filter f)
+{
+  return f == audio::Filter::Off ? audio::Filter::LowPass : audio::Filter::HighPass;
+}
+
+
+Vec2 scale(const Vec2 &v, float factor)
+{
+  return { v.x * factor, v.y * factor };
+}
+
+
+Vec2 *origin()
+{
+  static Vec2 o = { 0, 0 };
+  return &o;
+}
+
+
+geo::Vec2 flip(geo::Vec2 v)
+{
+  return { v.y, v.x };
+}
+
+
+std::vector<float> normalize(const std::vector<float> &values)
+{
+  float max = 0;
+  for (float value : values)
+    max = value > max ? value : max;
+
+  std::vector<float> result(values);
+  for (float &value : result)
+    value = max > 0 ? value / max : 0;
+  return result;
+}
+
+
+std::map<std::string, int> histogram(const std::vector<Filter> &filters)
+{
+  std::map<std::string, int> result;
+  for (Filter f : filters)
+    result[f == Filter::Linear ? "Linear" : "Nearest"]++;
+  return result;
+}
+
+
+std::vector<float> ramp(int count)
+{
+  std::vector<float> result(count > 0 ? count : 0);
+  for (size_t i = 0; i < result.size(); i++)
+    result[i] = (float)i / result.size();
+  return result;
+}
+
+
+const std::map<std::string, int> &filterIds()
+{
+  static const std::map<std::string, int> ids({ { "Nearest", (int)Filter::Nearest }, { "Linear", (int)Filter::Linear } });
+  return ids;
+}
+
+
+int slowSum(int a, int b)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  return a + b;
+}
+
+
+const char *version()
+{
+  return "TestTarget 1.0";
+}
+
+
+const char *describe(const Vec2 &v)
+{
+  const int size = snprintf(nullptr, 0, "Vec2(%g, %g)", v.x, v.y) + 1;
+  char *text = static_cast<char *>(malloc(size));
+  snprintf(text, size, "Vec2(%g, %g)", v.x, v.y);
+  return text;
+}
+
+
+void forEachSample(int count, std::function<void(int, float)> callback)
+{
+  for (int i = 0; i < count; i++)
+    callback(i, i * 0.5f);
+}
+
+
+void repeat(int times, void (*callback)(int i, void *userdata), void *userdata)
+{
+  for (int i = 0; i < times; i++)
+    callback(i, userdata);
+}
+
+
+static void (*tickCallback)(int i, void *userdata) = nullptr;
+static void *tickUserData = nullptr;
+static int ticks = 0;
+
+
+void startTicking(void (*callback)(int i, void *userdata), void *userdata)
+{
+  stopTicking();
+  tickCallback = callback;
+  tickUserData = userdata;
+}
+
+
+void tick()
+{
+  if (tickCallback)
+    tickCallback(ticks++, tickUserData);
+}
+
+
+void stopTicking()
+{
+  if (tickCallback)
+    rtjs::releaseCallback(tickUserData);
+
+  tickCallback = nullptr;
+  tickUserData = nullptr;
+}
+
+
 void TestClass::test()
 {
   std::cerr << "TestClass::test called" << std::endl;
@@ -27,3 +169,60 @@ void TestClass::static_test()
 {
   std::cerr << "TestClass::static_test called" << std::endl;
 }
+
+
+std::string Named::title() const
+{
+  return "Named " + name;
+}
+
+
+int tools::Named::length() const
+{
+  return (int)name.size();
+}
+
+
+void Counter::bump(int by)
+{
+  count += by;
+}
+
+
+int countOf(const TestClass &object)
+{
+  return object.count;
+}
+
+
+std::string nameOf(const Named *named)
+{
+  return named->name;
+}
+
+
+std::shared_ptr<Counter> sharedCounter()
+{
+  static std::shared_ptr<Counter> counter(std::make_shared<Counter>());
+  return counter;
+}
+
+
+std::unique_ptr<Named> makeNamed(const std::string &name)
+{
+  std::unique_ptr<Named> named(new Named);
+  named->name = name;
+  return named;
+}
+
+
+int useCount(std::shared_ptr<TestClass> object)
+{
+  return (int)object.use_count();
+}
+
+
+std::string consume(std::unique_ptr<Named> named)
+{
+  return named->title();
+}
@@ -2,9 +2,137 @@ bool x(bool y);
 bool *x2(bool *y);
 
 
+enum class Filter
+{
+  Nearest,
+  Linear,
+};
+
+Filter filter(Filter f);
+
+
+namespace audio
+{
+
+enum class Filter
+{
+  Off,
+  LowPass,
+  HighPass,
+};
+
+}
+
+audio::Filter steeper(audio::Filter f); // same enum name in another scope
+
+
+struct Vec2
+{
+  float x;
+  float y;
+};
+
+[[rtjs::validation(trusted)]] Vec2 scale(const Vec2 &v, float factor); // hot, only called by our own scripts
+Vec2 *origin();
+
+
+namespace geo
+{
+
+struct Vec2
+{
+  double x;
+  double y;
+};
+
+}
+
+geo::Vec2 flip(geo::Vec2 v); // same struct name in another scope
+
+
+#include <map>
+#include <string>
+#include <vector>
+
+std::vector<float> normalize(const std::vector<float> &values);
+std::map<std::string, int> histogram(const std::vector<Filter> &filters);
+
+// iterables instead of arrays, elements get converted as scripts pull them
+[[rtjs::lazy]] std::vector<float> ramp(int count);
+[[rtjs::lazy]] const std::map<std::string, int> &filterIds(); // borrowed, lives as long as the program
+
+int slowSum(int a, int b); // async, see CMakeLists.txt
+
+
+// returned without copying into the js heap
+[[rtjs::static_string]] const char *version();
+[[rtjs::owned_string]] const char *describe(const Vec2 &v); // malloc'ed, freed by the engine
+
+
+#include <functional>
+
+void forEachSample(int count, std::function<void(int, float)> callback);
+void repeat(int times, void (*callback)(int i, void *userdata), void *userdata); // calls back before it returns
+
+// calls back from tick() until stopTicking() hands the userdata back with rtjs::releaseCallback()
+[[rtjs::retain_callback]] void startTicking(void (*callback)(int i, void *userdata), void *userdata);
+void tick();
+void stopTicking();
+
+
 class TestClass
 {
 public:
   void test();
   static void static_test();
+
+  int count = 0;
+  const int id = 42; // read-only from js
+  std::string label;
+};
+
+
+class Named
+{
+public:
+  std::string title() const;
+
+  std::string name = "unnamed";
+};
+
+// in js the prototype of TestClass is the prototype of this one's, the members of Named are mixed in
+class Counter : public TestClass, public Named
+{
+public:
+  void bump(int by);
 };
+
+namespace tools
+{
+
+class Named // same class name in another scope, tools_Named in js
+{
+public:
+  struct Part // nested, not wrapped
+  {
+    int size;
+  };
+
+  int length() const;
+
+  std::string name = "tool";
+};
+
+}
+
+int countOf(const TestClass &object); // Counter objects as well
+std::string nameOf(const Named *named); // the Named of a Counter lies at an offset
+
+
+#include <memory>
+
+// ownership kept in the wrapper
+std::shared_ptr<Counter> sharedCounter(); // alive while native code or a wrapper holds it
+std::unique_ptr<Named> makeNamed(const std::string &name); // deleted with its wrapper
+int useCount(std::shared_ptr<TestClass> object); // shares the ownership of the wrapper
+std::string consume(std::unique_ptr<Named> named); // takes the object, the wrapper is detached
@@ -1,19 +1,47 @@
 #include <QCoreApplication>
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileSystemWatcher>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QString>
 #include <QDebug>
-
+#include <QRegularExpression>
+#include <QLocalServer>
+#include <QLocalSocket>
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <map>
+#include <memory>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 
 #include <cppast/code_generator.hpp>         // for generate_code()
+#include <cppast/cpp_attribute.hpp>          // for has_attribute()
+#include <cppast/cpp_class.hpp>              // for cpp_class, cpp_base_class
 #include <cppast/cpp_entity_kind.hpp>        // for the cpp_entity_kind definition
+#include <cppast/cpp_enum.hpp>               // for cpp_enum, cpp_enum_value
 #include <cppast/cpp_forward_declarable.hpp> // for is_definition()
 #include <cppast/cpp_namespace.hpp>          // for cpp_namespace
+#include <cppast/cpp_preprocessor.hpp>       // for cpp_include_directive
 #include <cppast/cpp_type.hpp>
 #include <cppast/cpp_member_function.hpp>
+#include <cppast/cpp_member_variable.hpp>
 #include <cppast/libclang_parser.hpp> // for libclang_parser, libclang_compile_config, cpp_entity,...
 #include <cppast/visitor.hpp>         // for visit()
 
+#include <clang-c/Index.h> // for building precompiled headers, not exposed by cppast
+
 
 using namespace std;
 
@@ -22,11 +50,26 @@ enum class ParamType
 {
   Unknown = 0,
   JSCompatible, // bool, int, string, etc.  (too general??)
+  Void, // return only
 
   Boolean,
+  Number, // arithmetic built-ins
 
   Pointer, // set raw pointer to raw data
   Object, // class, struct, etc.
+  Enum, // number or enumerator name string
+  Struct, // POD struct, copied from / to a plain object
+  StructPointer, // POD struct, shared with a view object
+  ClassPointer, // class exposed by rtjsgen, the object behind its wrapper (or the one of a derived class)
+  ClassReference, // same, passed as reference
+  ClassShared, // std::shared_ptr to a wrapped class, ownership shared with the wrapper
+  ClassUnique, // std::unique_ptr to a wrapped class, ownership moves between native code and the wrapper
+  String, // std::string
+  CharString, // const char *, std::string_view
+  Container, // std::vector, std::array, std::map, std::unordered_map
+  Callback, // std::function, from a js function
+  CallbackPointer, // function pointer with a void * userdata argument, from a js function
+  UserData, // the void * userdata parameter going with a CallbackPointer, not visible to js
 };
 
 
@@ -36,6 +79,7 @@ public:
   QString mName;
   QString mType;
   ParamType paramType;// = ParamType::Unknown;
+  int mCallbackParam; // ParamType::UserData only: index of the CallbackPointer parameter it goes with
 };
 
 
@@ -46,12 +90,37 @@ public:
 };
 
 
+// who keeps a returned ParamType::CharString alive
+enum class StringStorage
+{
+  Copy, // nobody after the call, the engine copies it
+  Static, // [[rtjs::static_string]]: native code, for as long as the engine runs
+  Owned, // [[rtjs::owned_string]]: malloc'ed, handed over to the engine, which frees it with the string
+};
+
+
+// argument checks of the generated handlers
+enum class Validation
+{
+  Default, // the one of the target (--validation)
+  Debug, // count, types and integer ranges, errors name the parameter and what was passed instead
+  Checked, // count and type tags only
+  Trusted, // none, for scripts known to call correctly
+};
+
+
 class Function : public FunctionBase
 {
 public:
   QString mName;
   QString mReturnTypeString;
   ParamType mReturnType = ParamType::Unknown;
+  StringStorage mStringStorage = StringStorage::Copy;
+  Validation mValidation = Validation::Default; // [[rtjs::validation(level)]]
+  bool mLazy = false; // [[rtjs::lazy]]: a returned container becomes an iterable converting elements on demand
+  bool mBorrowed = false; // a lazy container returned by reference, it has to outlive the iterable
+  bool mAsync = false; // called on the worker pool, returns a promise
+  bool mRetainCallback = false; // [[rtjs::retain_callback]]: native code owns the userdata of a function pointer
 };
 
 
@@ -62,185 +131,1735 @@ public:
 };
 
 
-class StaticFunction : public Function
+class StaticFunction : public Function
+{
+public:
+
+};
+
+
+class Ctor : public FunctionBase
+{
+
+};
+
+
+class Field
+{
+public:
+  QString mName;
+  QString mType;
+  ParamType mParamType = ParamType::Unknown;
+  bool mConst = false;
+};
+
+
+class ClassDef
+{
+public:
+  bool mValid = false;
+  QString mName; // qualified, like the ones of enums
+  QString mId; // used in the names of the generated code
+  QVector<Ctor> mCtors;
+  QVector<MemberFunction> mMemberFunctions;
+  QVector<StaticFunction> mStaticFunctions;
+  QVector<Field> mFields;
+  QStringList mBases; // public non-virtual ones, in declaration order
+  bool mVirtualDtor = false; // declared virtual here, see hasVirtualDestructor() for inherited ones
+  bool mPod = true; // no ctors, no bases, no methods, only public marshallable fields
+};
+
+
+class EnumDef
+{
+public:
+  QString mName; // qualified, enums in namespaces and classes get all their scopes
+  QString mId; // used in the names of the generated converters
+  QStringList mValues;
+};
+
+
+class ContainerDef
+{
+public:
+  enum class Kind
+  {
+    Vector,
+    Array,
+    Map,
+  };
+
+  QString mId; // used in the names of the generated converters
+  QString mCppType;
+  Kind mKind = Kind::Vector;
+  QString mSize; // std::array only
+
+  ParamType mKeyType = ParamType::Unknown; // maps only
+  QString mKeyTypeString;
+  ParamType mElementType = ParamType::Unknown;
+  QString mElementTypeString;
+
+  bool mLazy = false; // returned as iterable by some function
+};
+
+
+class CallbackArg
+{
+public:
+  QString mCppType; // as declared
+  ParamType mType = ParamType::Unknown;
+  QString mTypeString;
+};
+
+
+class CallbackDef
+{
+public:
+  QString mId; // used in the names of the generated trampolines
+  QString mSignature; // R(A, B)
+  CallbackArg mReturn;
+  QVector<CallbackArg> mArgs;
+  int mUserDataArg = -1; // function pointers only
+};
+
+
+// decides which headers are parsed and which entities end up in the model
+class ScopeFilter
+{
+public:
+  QVector<QRegularExpression> mFiles; // file globs, empty: all given headers
+  QStringList mNamespaces; // including nested ones, empty: all
+  QVector<QRegularExpression> mExcludes; // qualified name globs
+  bool mExportOnly = false; // only [[rtjs::export]] entities (and everything in exported classes / namespaces)
+
+  static QRegularExpression glob(const QString &pattern)
+  {
+    return QRegularExpression(QRegularExpression::wildcardToRegularExpression(pattern));
+  }
+
+  bool acceptsFile(const QString &filename) const
+  {
+    if (mFiles.isEmpty())
+      return true;
+
+    const QString name(QFileInfo(filename).fileName());
+    for (const QRegularExpression &file : mFiles)
+    {
+      if (file.match(filename).hasMatch() || file.match(name).hasMatch())
+        return true;
+    }
+    return false;
+  }
+
+  // a namespace is entered if it is selected or contains a selected one
+  bool entersNamespace(const QString &ns) const
+  {
+    if (mNamespaces.isEmpty())
+      return true;
+
+    for (const QString &selected : mNamespaces)
+    {
+      if (ns == selected || ns.startsWith(selected + "::") || selected.startsWith(ns + "::"))
+        return true;
+    }
+    return false;
+  }
+
+  bool acceptsNamespace(const QString &ns) const
+  {
+    if (mNamespaces.isEmpty())
+      return true;
+
+    for (const QString &selected : mNamespaces)
+    {
+      if (ns == selected || ns.startsWith(selected + "::"))
+        return true;
+    }
+    return false;
+  }
+
+  bool accepts(const cppast::cpp_entity &e) const
+  {
+    if (cppast::has_attribute(e, "rtjs::ignore"))
+      return false;
+
+    const QString name(qualifiedName(e));
+    for (const QRegularExpression &exclude : mExcludes)
+    {
+      if (exclude.match(name).hasMatch() || exclude.match(QString::fromStdString(e.name())).hasMatch())
+        return false;
+    }
+
+    if (e.kind() == cppast::cpp_entity_kind::namespace_t)
+      return entersNamespace(name);
+
+    if (!acceptsNamespace(enclosingNamespace(e)))
+      return false;
+
+    return !mExportOnly || isExported(e);
+  }
+
+  static bool isExported(const cppast::cpp_entity &e)
+  {
+    if (cppast::has_attribute(e, "rtjs::export"))
+      return true;
+
+    // namespaces are only passed through, they don't export their content by themselves
+    if (e.kind() == cppast::cpp_entity_kind::namespace_t)
+      return true;
+
+    for (auto parent = e.parent(); parent; parent = parent.value().parent())
+    {
+      if (cppast::has_attribute(parent.value(), "rtjs::export"))
+        return true;
+    }
+    return false;
+  }
+
+  static QString qualifiedName(const cppast::cpp_entity &e)
+  {
+    QString name(QString::fromStdString(e.name()));
+    for (auto parent = e.parent(); parent; parent = parent.value().parent())
+    {
+      if (parent.value().kind() == cppast::cpp_entity_kind::namespace_t || parent.value().kind() == cppast::cpp_entity_kind::class_t)
+        name.prepend(QString::fromStdString(parent.value().name()) + "::");
+    }
+    return name;
+  }
+
+  static QString enclosingNamespace(const cppast::cpp_entity &e)
+  {
+    QStringList ns;
+    for (auto parent = e.parent(); parent; parent = parent.value().parent())
+    {
+      if (parent.value().kind() == cppast::cpp_entity_kind::namespace_t)
+        ns.prepend(QString::fromStdString(parent.value().name()));
+    }
+    return ns.join("::");
+  }
+};
+
+
+QMap<QString, EnumDef> enumDefs; // by qualified name
+QMap<QString, ClassDef> structDefs; // classes marshalled by value (see ClassDef::mPod)
+QMap<QString, ClassDef> classDefs; // classes wrapped by reference
+QVector<ContainerDef> containerDefs; // in dependency order, nested containers first
+QVector<CallbackDef> callbackDefs; // one trampoline per signature
+
+
+// FNV-1a with a seed, must match _rtjs_hash() in init-head.tpl
+quint32 hashName(const QByteArray &name, quint32 seed)
+{
+  quint32 hash = 2166136261u ^ seed;
+  for (char c : name)
+  {
+    hash ^= (quint8)c;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+
+// find a table size (power of two) and seed for which the enumerator names don't collide,
+// so the generated lookup is a single probe + memcmp
+bool findPerfectHash(const QStringList &names, int &tableSize, quint32 &seed)
+{
+  tableSize = 1;
+  while (tableSize < names.count())
+    tableSize <<= 1;
+
+  for (; tableSize <= qMax(names.count(), 1) * 8; tableSize <<= 1)
+  {
+    for (seed = 0; seed < 100000; seed++)
+    {
+      QVector<bool> used(tableSize, false);
+      bool collision = false;
+
+      for (const QString &name : names)
+      {
+        int slot = hashName(name.toUtf8(), seed) & (tableSize - 1);
+        if (used.at(slot))
+        {
+          collision = true;
+          break;
+        }
+        used[slot] = true;
+      }
+
+      if (!collision)
+        return true;
+    }
+  }
+
+  return false;
+}
+
+
+// the qualified name of the definition spelled as spelling, a name without all of its scopes has to be unique
+template<typename Def>
+QString qualifiedName(const QMap<QString, Def> &defs, const QString &spelling)
+{
+  QString name(spelling.trimmed());
+  if (name.startsWith("::"))
+    name.remove(0, 2);
+
+  if (defs.contains(name))
+    return name;
+
+  QStringList candidates;
+  for (const Def &def : defs)
+  {
+    if (def.mName.endsWith("::" + name))
+      candidates += def.mName;
+  }
+
+  if (candidates.count() > 1)
+    qWarning() << name << "is ambiguous, qualify it:" << candidates;
+
+  return candidates.count() == 1 ? candidates.first() : QString();
+}
+
+
+QString enumName(const QString &spelling)
+{
+  return qualifiedName(enumDefs, spelling);
+}
+
+
+bool isValueType(ParamType type)
+{
+  switch (type)
+  {
+    case ParamType::Boolean:
+    case ParamType::Number:
+    case ParamType::Enum:
+    case ParamType::Struct:
+    case ParamType::String:
+    case ParamType::Container:
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+
+ParamType getContainerType(const QString &spelling, QString &typeString);
+
+
+// for template arguments, which are only available as text
+ParamType getTypeFromName(const QString &name, QString &typeString)
+{
+  static const QStringList numbers({ "char", "signed char", "unsigned char", "short", "unsigned short",
+                                     "int", "unsigned", "unsigned int", "long", "unsigned long",
+                                     "long long", "unsigned long long", "float", "double",
+                                     "int8_t", "uint8_t", "int16_t", "uint16_t", "int32_t", "uint32_t",
+                                     "int64_t", "uint64_t", "size_t" });
+  static const QRegularExpression stdPrefix("^std::");
+
+  static const QRegularExpression qualifiers("^const\\s+|\\s*&+$");
+
+  typeString = name.trimmed().remove(qualifiers);
+
+  if (typeString == "bool")
+    return ParamType::Boolean;
+
+  if (typeString == "void")
+    return ParamType::Void;
+
+  if (numbers.contains(QString(typeString).remove(stdPrefix)))
+    return ParamType::Number;
+
+  if (typeString == "std::string" || typeString == "string")
+  {
+    typeString = "std::string";
+    return ParamType::String;
+  }
+
+  const QString enumType(enumName(typeString));
+  if (!enumType.isEmpty())
+  {
+    typeString = enumType;
+    return ParamType::Enum;
+  }
+
+  const QString structType(qualifiedName(structDefs, typeString));
+  if (!structType.isEmpty())
+  {
+    typeString = structType;
+    return ParamType::Struct;
+  }
+
+  return getContainerType(QString(typeString), typeString);
+}
+
+
+QStringList splitTemplateArguments(const QString &arguments)
+{
+  QStringList result;
+  int depth = 0;
+  int start = 0;
+
+  for (int i = 0; i < arguments.length(); i++)
+  {
+    const QChar c(arguments.at(i));
+
+    if (c == '<')
+      depth++;
+    else if (c == '>')
+      depth--;
+    else if (c == ',' && depth == 0)
+    {
+      result += arguments.mid(start, i - start).trimmed();
+      start = i + 1;
+    }
+  }
+
+  result += arguments.mid(start).trimmed();
+  return result;
+}
+
+
+ParamType getContainerType(const QString &spelling, QString &typeString)
+{
+  static const QRegularExpression containerRe("^(?:std::)?(vector|array|map|unordered_map)\\s*<(.*)>$");
+  static const QRegularExpression nonIdentifier("[^A-Za-z0-9]+");
+
+  const QRegularExpressionMatch match(containerRe.match(spelling.trimmed()));
+  const QStringList arguments(match.hasMatch() ? splitTemplateArguments(match.captured(2)) : QStringList());
+
+  typeString = "auto /* unknown */"; // hide our failure
+
+  if (arguments.count() < (match.captured(1) == "vector" ? 1 : 2))
+    return ParamType::Object;
+
+  ContainerDef container;
+  container.mCppType = QString("std::%1<%2>").arg(match.captured(1), match.captured(2));
+  container.mId = QString(container.mCppType).replace(nonIdentifier, "_");
+  while (container.mId.endsWith('_'))
+    container.mId.chop(1);
+
+  if (match.captured(1) == "vector" || match.captured(1) == "array")
+  {
+    container.mKind = match.captured(1) == "vector" ? ContainerDef::Kind::Vector : ContainerDef::Kind::Array;
+    container.mSize = match.captured(1) == "array" ? arguments.at(1) : QString();
+    container.mElementType = getTypeFromName(arguments.at(0), container.mElementTypeString);
+  }
+  else
+  {
+    container.mKind = ContainerDef::Kind::Map;
+    container.mKeyType = getTypeFromName(arguments.at(0), container.mKeyTypeString);
+    container.mElementType = getTypeFromName(arguments.at(1), container.mElementTypeString);
+
+    if (container.mKeyType != ParamType::String && container.mKeyType != ParamType::Enum && container.mKeyType != ParamType::Number)
+      return ParamType::Object;
+  }
+
+  if (!isValueType(container.mElementType))
+    return ParamType::Object;
+
+  bool known = false;
+  for (const ContainerDef &other : qAsConst(containerDefs))
+    known |= other.mId == container.mId;
+
+  if (!known)
+    containerDefs += container;
+
+  typeString = container.mId;
+  return ParamType::Container;
+}
+
+
+// "R(A, B)" or "R (*)(A, B)"
+ParamType getCallbackType(QString signature, bool pointer, QString &typeString)
+{
+  static const QRegularExpression pointerDeclarator("\\(\\s*\\*\\s*\\)");
+  static const QRegularExpression voidPointer("^void\\s*\\*$");
+  static const QRegularExpression nonIdentifier("[^A-Za-z0-9]+");
+
+  typeString = "auto /* unknown */"; // hide our failure
+
+  signature.remove(pointerDeclarator);
+  const int open = signature.indexOf('(');
+  if (open < 0 || !signature.endsWith(')'))
+    return ParamType::Object;
+
+  CallbackDef callback;
+  callback.mReturn.mCppType = signature.left(open).trimmed();
+  callback.mReturn.mType = getTypeFromName(callback.mReturn.mCppType, callback.mReturn.mTypeString);
+
+  if (callback.mReturn.mType != ParamType::Void && !isValueType(callback.mReturn.mType))
+    return ParamType::Object;
+
+  QStringList argTypes(splitTemplateArguments(signature.mid(open + 1, signature.length() - open - 2)));
+  if (argTypes == QStringList({ "" }) || argTypes == QStringList({ "void" }))
+    argTypes.clear();
+
+  for (const QString &argType : qAsConst(argTypes))
+  {
+    CallbackArg arg;
+    arg.mCppType = argType;
+
+    if (pointer && callback.mUserDataArg == -1 && voidPointer.match(argType).hasMatch())
+    {
+      arg.mType = ParamType::UserData;
+      callback.mUserDataArg = callback.mArgs.count();
+    }
+    else
+    {
+      arg.mType = getTypeFromName(argType, arg.mTypeString);
+      if (!isValueType(arg.mType))
+        return ParamType::Object;
+    }
+
+    callback.mArgs += arg;
+  }
+
+  if (pointer && callback.mUserDataArg == -1) // nowhere to keep the js function
+    return ParamType::Object;
+
+  callback.mSignature = QString("%1(%2)").arg(callback.mReturn.mCppType, argTypes.join(", "));
+  callback.mId = ("callback_" + callback.mSignature).replace(nonIdentifier, "_");
+  while (callback.mId.endsWith('_'))
+    callback.mId.chop(1);
+
+  bool known = false;
+  for (const CallbackDef &other : qAsConst(callbackDefs))
+    known |= other.mId == callback.mId;
+
+  if (!known)
+    callbackDefs += callback;
+
+  typeString = callback.mId;
+  return pointer ? ParamType::CallbackPointer : ParamType::Callback;
+}
+
+
+// the name of the (cv-qualified) class type if rtjsgen wraps that class, empty otherwise.
+// classes are known from the end of their definition on, like structs
+QString exposedClass(const cppast::cpp_type &type)
+{
+  const cppast::cpp_type *unqualified = &type;
+  if (type.kind() == cppast::cpp_type_kind::cv_qualified_t)
+    unqualified = &static_cast<const cppast::cpp_cv_qualified_type &>(type).type();
+
+  if (unqualified->kind() != cppast::cpp_type_kind::user_defined_t)
+    return QString();
+
+  return qualifiedName(classDefs, QString::fromStdString(static_cast<const cppast::cpp_user_defined_type &>(*unqualified).entity().name()));
+}
+
+
+// how often base is an ancestor of the class name, more than once: an ambiguous base, no static upcast
+int ancestorCount(const QString &name, const QString &base)
+{
+  int count = 0;
+  for (const QString &parent : classDefs.value(name).mBases)
+    count += (parent == base) + ancestorCount(parent, base);
+  return count;
+}
+
+
+// 0 for classes without bases, bases always have a smaller one than the classes derived from them
+int inheritanceDepth(const QString &name)
+{
+  int depth = 0;
+  for (const QString &parent : classDefs.value(name).mBases)
+    depth = qMax(depth, inheritanceDepth(parent) + 1);
+  return depth;
+}
+
+
+// whether deleting through a name pointer is fine for the objects of derived classes as well
+bool hasVirtualDestructor(const QString &name)
+{
+  const ClassDef c(classDefs.value(name));
+  if (c.mVirtualDtor)
+    return true;
+
+  for (const QString &parent : c.mBases)
+  {
+    if (hasVirtualDestructor(parent))
+      return true;
+  }
+  return false;
+}
+
+
+// the bases that are wrapped as well, the first one becomes the prototype of the prototype
+QStringList exposedBases(const ClassDef &c)
+{
+  QStringList bases;
+  for (const QString &base : c.mBases)
+  {
+    if (classDefs.contains(base))
+      bases += base;
+  }
+  return bases;
+}
+
+
+ParamType getType(const cppast::cpp_type &type, QString &typeString)
+{
+  switch (type.kind())
+  {
+    case cppast::cpp_type_kind::builtin_t:
+    {
+      auto& builtin = static_cast<const cppast::cpp_builtin_type &>(type);
+
+      switch (builtin.builtin_type_kind())
+      {
+        case cppast::cpp_builtin_type_kind::cpp_bool:
+        {
+          typeString = "bool";
+          return ParamType::Boolean;
+        }
+
+        case cppast::cpp_builtin_type_kind::cpp_void:
+        {
+          typeString = "void";
+          return ParamType::Void;
+        }
+
+        case cppast::cpp_builtin_type_kind::cpp_char:
+        case cppast::cpp_builtin_type_kind::cpp_schar:
+        case cppast::cpp_builtin_type_kind::cpp_uchar:
+        case cppast::cpp_builtin_type_kind::cpp_short:
+        case cppast::cpp_builtin_type_kind::cpp_ushort:
+        case cppast::cpp_builtin_type_kind::cpp_int:
+        case cppast::cpp_builtin_type_kind::cpp_uint:
+        case cppast::cpp_builtin_type_kind::cpp_long:
+        case cppast::cpp_builtin_type_kind::cpp_ulong:
+        case cppast::cpp_builtin_type_kind::cpp_longlong:
+        case cppast::cpp_builtin_type_kind::cpp_ulonglong:
+        case cppast::cpp_builtin_type_kind::cpp_float:
+        case cppast::cpp_builtin_type_kind::cpp_double:
+        {
+          typeString = QString::fromUtf8(cppast::to_string(builtin.builtin_type_kind()));
+          return ParamType::Number;
+        }
+
+        // etc....
+
+        default:
+        {
+          typeString = "auto /* built-in unknown */"; // oops, try to hide the failure :)
+          return ParamType::JSCompatible;
+        }
+      }
+    }
+
+    case cppast::cpp_type_kind::cv_qualified_t:
+    {
+      // a by-value "const X" marshals just like "X"
+      auto& qualified = static_cast<const cppast::cpp_cv_qualified_type &>(type);
+      return getType(qualified.type(), typeString);
+    }
+
+    case cppast::cpp_type_kind::reference_t:
+    {
+      // non-const reference parameters are turned down by getFunctionParameters()
+      auto& reference = static_cast<const cppast::cpp_reference_type &>(type);
+
+      typeString = exposedClass(reference.referee());
+      if (!typeString.isEmpty())
+        return ParamType::ClassReference;
+
+      return getType(reference.referee(), typeString);
+    }
+
+    case cppast::cpp_type_kind::user_defined_t:
+    {
+      auto& userDefined = static_cast<const cppast::cpp_user_defined_type &>(type);
+      typeString = QString::fromStdString(userDefined.entity().name());
+
+      const QString enumType(enumName(typeString));
+      if (!enumType.isEmpty())
+      {
+        typeString = enumType;
+        return ParamType::Enum;
+      }
+
+      const QString structType(qualifiedName(structDefs, typeString));
+      if (!structType.isEmpty())
+      {
+        typeString = structType;
+        return ParamType::Struct;
+      }
+
+      if (typeString == "std::string" || typeString == "string")
+      {
+        typeString = "std::string";
+        return ParamType::String;
+      }
+
+      if (typeString == "std::string_view" || typeString == "string_view")
+      {
+        typeString = "std::string_view";
+        return ParamType::CharString;
+      }
+
+      typeString = "auto /* unknown */"; // hide our failure
+      return ParamType::Object; // ???
+    }
+
+    case cppast::cpp_type_kind::template_instantiation_t:
+    case cppast::cpp_type_kind::unexposed_t:
+    {
+      static const QRegularExpression functionRe("^(?:std::)?function\\s*<(.*)>$");
+
+      const QString spelling(QString::fromStdString(cppast::to_string(type)).trimmed());
+      const QRegularExpressionMatch match(functionRe.match(spelling));
+
+      if (match.hasMatch())
+        return getCallbackType(match.captured(1), false, typeString);
+
+      if (spelling == "std::string_view" || spelling == "string_view")
+      {
+        typeString = "std::string_view";
+        return ParamType::CharString;
+      }
+
+      static const QRegularExpression smartPointerRe("^(?:std::)?(shared_ptr|unique_ptr)\\s*<\\s*([\\w:]+)\\s*>$");
+      const QRegularExpressionMatch smartPointer(smartPointerRe.match(spelling));
+      const QString pointee(smartPointer.hasMatch() ? qualifiedName(classDefs, smartPointer.captured(2)) : QString());
+      if (!pointee.isEmpty())
+      {
+        typeString = pointee;
+        return smartPointer.captured(1) == "shared_ptr" ? ParamType::ClassShared : ParamType::ClassUnique;
+      }
+
+      return getContainerType(spelling, typeString);
+    }
+
+    case cppast::cpp_type_kind::pointer_t:
+    {
+      //std::cerr << "POINTER KIND: " << (int)param.kind() << std::endl;
+      //std::cerr << "POINTER TYPE KIND: " << (int)param.type().kind() << std::endl;
+
+      auto& pointer = static_cast<const cppast::cpp_pointer_type &>(type);
+      //std::cerr << "POINTER POINTEE KIND: " << (int)pointer.pointee().kind() << std::endl;
+
+      if (pointer.pointee().kind() == cppast::cpp_type_kind::function_t)
+        return getCallbackType(QString::fromStdString(cppast::to_string(type)), true, typeString);
+
+      typeString = exposedClass(pointer.pointee());
+      if (!typeString.isEmpty())
+        return ParamType::ClassPointer;
+
+      if (QString::fromStdString(cppast::to_string(pointer.pointee())) == "const char")
+      {
+        typeString = "const char *";
+        return ParamType::CharString;
+      }
+
+      if (pointer.pointee().kind() == cppast::cpp_type_kind::builtin_t)
+      {
+        auto& builtin = static_cast<const cppast::cpp_builtin_type &>(pointer.pointee());
+        // cpp_builtin_type_kind \/
+        typeString = QString::fromUtf8(cppast::to_string(builtin.builtin_type_kind()));
+        //std::cerr << "builtin => " << typeString.toStdString().c_str() << "(" << (int)builtin.builtin_type_kind() << ")" << std::endl;
+
+      }
+      else if (pointer.pointee().kind() == cppast::cpp_type_kind::user_defined_t)
+      {
+        auto& userDefined = static_cast<const cppast::cpp_user_defined_type &>(pointer.pointee());
+        typeString = QString::fromStdString(userDefined.entity().name());
+
+        const QString structType(qualifiedName(structDefs, typeString));
+        if (!structType.isEmpty())
+        {
+          typeString = structType;
+          return ParamType::StructPointer;
+        }
+      }
+//        else ( pointer.pointee().kind() == cppast::cpp_type_kind::unexposed_t )
+//      {
+//    cpp_unexposed_type
+//    }
+
+
+
+      //pointer.kind()
+
+
+      typeString = QString("%1 *").arg(typeString);
+      //typeString = "auto *"; // TODO: un-auto
+      return ParamType::Pointer;
+    }
+
+    default:
+    {
+      typeString = "auto /* unknown */"; // hide our failure
+      return ParamType::Object; // ???
+    }
+  }
+}
+
+
+void getReturnType(Function &function, const cppast::cpp_type &returnType, const cppast::cpp_entity &e)
+{
+  function.mReturnType = getType(returnType, function.mReturnTypeString);
+
+  if (function.mReturnType == ParamType::Object || function.mReturnType == ParamType::JSCompatible)
+    function.mReturnType = ParamType::Unknown; // no return marshalling for these (yet)
+
+  // wrappers are mutable, scripts could call setters and non-const methods on a const object
+  if (function.mReturnType == ParamType::ClassPointer || function.mReturnType == ParamType::ClassReference)
+  {
+    const cppast::cpp_type *target = &returnType;
+    if (target->kind() == cppast::cpp_type_kind::cv_qualified_t)
+      target = &static_cast<const cppast::cpp_cv_qualified_type &>(*target).type();
+    target = target->kind() == cppast::cpp_type_kind::pointer_t
+        ? &static_cast<const cppast::cpp_pointer_type &>(*target).pointee()
+        : &static_cast<const cppast::cpp_reference_type &>(*target).referee();
+
+    if (target->kind() == cppast::cpp_type_kind::cv_qualified_t
+        && cppast::is_const(static_cast<const cppast::cpp_cv_qualified_type &>(*target).cv_qualifier()))
+    {
+      qWarning() << "not exposing" << QString::fromStdString(e.name()) << "(returns a const" << function.mReturnTypeString << ")";
+      function.mReturnType = ParamType::Unknown;
+    }
+  }
+
+  if (cppast::has_attribute(e, "rtjs::lazy"))
+  {
+    if (function.mReturnType != ParamType::Container)
+      qWarning() << "ignoring [[rtjs::lazy]] of" << QString::fromStdString(e.name()) << "(needs a container return)";
+    else
+    {
+      function.mLazy = true;
+      function.mBorrowed = returnType.kind() == cppast::cpp_type_kind::reference_t;
+
+      for (ContainerDef &container : containerDefs)
+        container.mLazy |= container.mId == function.mReturnTypeString;
+    }
+  }
+
+  const bool staticString = cppast::has_attribute(e, "rtjs::static_string").has_value();
+  const bool ownedString = cppast::has_attribute(e, "rtjs::owned_string").has_value();
+  if (!staticString && !ownedString)
+    return;
+
+  if (function.mReturnType != ParamType::CharString || (staticString && ownedString))
+    qWarning() << "ignoring the string storage attribute of" << QString::fromStdString(e.name()) << "(needs one of them on a const char * or std::string_view return)";
+  else
+    function.mStringStorage = staticString ? StringStorage::Static : StringStorage::Owned;
+}
+
+
+Validation parseValidation(QString level)
+{
+  level = level.trimmed().remove('"');
+
+  if (level == "debug")
+    return Validation::Debug;
+  if (level == "checked")
+    return Validation::Checked;
+  if (level == "trusted")
+    return Validation::Trusted;
+
+  qWarning() << "unknown validation level" << level << "(must be debug, checked or trusted)";
+  return Validation::Default;
+}
+
+
+Validation getValidation(const cppast::cpp_entity &e)
+{
+  auto attribute = cppast::has_attribute(e, "rtjs::validation");
+  if (!attribute || !attribute.value().arguments())
+    return Validation::Default;
+
+  return parseValidation(QString::fromStdString(attribute.value().arguments().value().as_string()));
+}
+
+
+// TODO: accept cpp_function_base instead of params
+void getFunctionParameters(FunctionBase &function, cppast::detail::iteratable_intrusive_list<cppast::cpp_function_parameter> params)
+{
+  std::for_each(params.begin(), params.end(), [&function](const cppast::cpp_function_parameter &param)
+  {
+    QString paramName(QString::fromStdString(param.name()));
+    //qWarning() << "param type int" << (int)param.type().kind() << "for param with name" << paramName;
+
+    QString typeString;
+    ParamType type = getType(param.type(), typeString);
+
+    // values are converted into a copy, changes made through the reference would never make it back to js
+    if (param.type().kind() == cppast::cpp_type_kind::reference_t && type != ParamType::ClassReference)
+    {
+      auto &reference = static_cast<const cppast::cpp_reference_type &>(param.type());
+      const bool isConst = reference.referee().kind() == cppast::cpp_type_kind::cv_qualified_t
+          && cppast::is_const(static_cast<const cppast::cpp_cv_qualified_type &>(reference.referee()).cv_qualifier());
+
+      if (reference.reference_kind() == cppast::cpp_ref_lvalue && !isConst)
+      {
+        qWarning() << "parameter" << paramName << "is a non-const reference, only wrapped classes can be passed that way";
+        type = ParamType::Object;
+      }
+    }
+
+    function.mParams += { paramName, typeString, type };
+    //qWarning() << "parameter" << paramName << "is of type" << typeString;
+  });
+
+  // a function pointer callback needs a void * userdata parameter to carry the js function
+  for (int i = 0; i < function.mParams.count(); i++)
+  {
+    if (function.mParams.at(i).paramType != ParamType::CallbackPointer)
+      continue;
+
+    bool found = false;
+    for (Parameter &userData : function.mParams)
+    {
+      if (userData.paramType == ParamType::Pointer && userData.mType == "void *")
+      {
+        userData.paramType = ParamType::UserData;
+        userData.mCallbackParam = i;
+        found = true;
+        break;
+      }
+    }
+
+    if (!found)
+    {
+      qWarning() << "no void * userdata parameter for callback" << function.mParams.at(i).mName;
+      function.mParams[i].paramType = ParamType::Object;
+    }
+  }
+
+  //qWarning() << "???" << function.mParams.count();
+}
+
+
+// c++ expression creating a js value from the native expression "value"
+QString toJs(ParamType type, const QString &typeString, const QString &value)
+{
+  switch (type)
+  {
+    case ParamType::Boolean:
+      return QString("jerry_create_boolean(%1)").arg(value);
+
+    case ParamType::Number:
+      return QString("jerry_create_number((double)(%1))").arg(value);
+
+    case ParamType::Enum:
+      return QString("_rtjs_%1_to_js(%2)").arg(enumDefs.value(typeString).mId, value);
+
+    case ParamType::Struct:
+      return QString("_rtjs_%1_to_js(%2)").arg(structDefs.value(typeString).mId, value);
+
+    case ParamType::StructPointer:
+      return QString("_rtjs_%1_view(%2)").arg(structDefs.value(typeString).mId, value);
+
+    case ParamType::Pointer:
+      return QString("_rtjs_pointer_to_js((void *)(%1))").arg(value);
+
+    case ParamType::ClassPointer:
+      return QString("_rtjs_create_%1_object(%2)").arg(classDefs.value(typeString).mId, value);
+
+    case ParamType::ClassReference:
+      return QString("_rtjs_create_%1_object(&%2)").arg(classDefs.value(typeString).mId, value);
+
+    case ParamType::ClassShared:
+      return QString("_rtjs_share_%1_object(%2)").arg(classDefs.value(typeString).mId, value);
+
+    case ParamType::ClassUnique:
+      return QString("_rtjs_adopt_%1_object(std::move(%2))").arg(classDefs.value(typeString).mId, value);
+
+    case ParamType::Void:
+      return "jerry_create_undefined()";
+
+    case ParamType::String:
+    case ParamType::CharString:
+      return QString("_rtjs_string_to_js(%1)").arg(value);
+
+    case ParamType::Container:
+      return QString("_rtjs_%1_to_js(%2)").arg(typeString, value);
+
+    default:
+      return "oopstojs";
+  }
+}
+
+
+// like toJs(), for the return value of function. iterables are made by the runtime, outside of the audit
+QString returnToJs(const Function &function, const QString &value)
+{
+  if (function.mLazy && function.mBorrowed && !function.mAsync) // async results are copies anyway
+    return QString("RTJS_AUDIT_CREATED(_rtjs_%1_iterable::borrow(&%2))").arg(function.mReturnTypeString, value);
+
+  if (function.mLazy)
+    return QString("RTJS_AUDIT_CREATED(_rtjs_%1_iterable::own(std::move(%2)))").arg(function.mReturnTypeString, value);
+
+  switch (function.mStringStorage)
+  {
+    case StringStorage::Static:
+      return QString("_rtjs_external_string_to_js(%1, false)").arg(value);
+
+    case StringStorage::Owned:
+      return QString("_rtjs_external_string_to_js(%1, true)").arg(value);
+
+    default:
+      return toJs(function.mReturnType, function.mReturnTypeString, value);
+  }
+}
+
+
+// c++ expression converting the js value "value" to its native type
+QString fromJs(ParamType type, const QString &typeString, const QString &value)
+{
+  switch (type)
+  {
+    case ParamType::Boolean:
+      return QString("jerry_value_to_boolean(%1)").arg(value);
+
+    case ParamType::Number:
+      return QString("(%1)jerry_get_number_value(%2)").arg(typeString, value);
+
+    case ParamType::Enum:
+      return QString("_rtjs_%1_from_js(%2)").arg(enumDefs.value(typeString).mId, value);
+
+    case ParamType::Struct:
+      return QString("_rtjs_%1_from_js(%2)").arg(structDefs.value(typeString).mId, value);
+
+    case ParamType::Container:
+    case ParamType::Callback:
+      return QString("_rtjs_%1_from_js(%2)").arg(typeString, value);
+
+    case ParamType::String:
+    case ParamType::CharString: // into a std::string that lives for the call
+      return QString("_rtjs_string_from_js(%1)").arg(value);
+
+    default:
+      return "oopsfromjs";
+  }
+}
+
+
+// whether handlerBody() can convert all parameters and the return value
+bool isCallable(const Function &function)
+{
+  if (function.mReturnType == ParamType::Unknown)
+    return false;
+
+  for (const Parameter &p : function.mParams)
+  {
+    if (p.paramType == ParamType::Unknown || p.paramType == ParamType::Object || p.paramType == ParamType::JSCompatible)
+      return false;
+
+    // scripts can't be called back from a worker thread, the work of the pool is copied (std::function)
+    if (function.mAsync && (p.paramType == ParamType::Callback || p.paramType == ParamType::CallbackPointer || p.paramType == ParamType::ClassUnique))
+      return false;
+  }
+  return true;
+}
+
+
+// everything rtjs::Converter (rtjs/bindings.h) can marshal, for the table backend (--table)
+bool isTableCompatible(const Function &function)
+{
+  if (function.mAsync || function.mLazy || (function.mReturnType != ParamType::Void && !isValueType(function.mReturnType)))
+    return false;
+
+  // Converter<decay<A>>::fromJs() is an rvalue: a non-const reference can't bind to it, but those are
+  // ParamType::Object already (getFunctionParameters())
+  for (const Parameter &p : function.mParams)
+  {
+    if (!isValueType(p.paramType) && p.paramType != ParamType::Callback)
+      return false;
+  }
+  return true;
+}
+
+
+// rtjs::Converter for a type rtjsgen generates converters for.
+// different spellings can name the same type (std::vector<int> and std::vector<int32_t>), so types
+// that can be spelled in several ways are guarded against the ones already specialized: the first
+// spelling of a type wins, instead of a redefinition
+QString converterSpecialization(const QString &cppType, const QString &id, bool toJs, QStringList *specialized = nullptr)
+{
+  QString code;
+  if (specialized)
+  {
+    QString condition(QString("std::is_same<T, %1>::value").arg(cppType));
+    for (const QString &other : qAsConst(*specialized))
+      condition += QString("\n    && !std::is_same<T, %1>::value").arg(other);
+    *specialized += cppType;
+
+    code += "template<typename T>\n";
+    code += QString("struct rtjs::Converter<T, typename std::enable_if<%1>::type>\n").arg(condition);
+  }
+  else
+  {
+    code += "template<>\n";
+    code += QString("struct rtjs::Converter<%1>\n").arg(cppType);
+  }
+  code += "{\n";
+  code += QString("  static %1 fromJs(const jerry_value_t value) { return _rtjs_%2_from_js(value); }\n").arg(cppType, id);
+  if (toJs)
+    code += QString("  static jerry_value_t toJs(const %1 &value) { return _rtjs_%2_to_js(value); }\n").arg(cppType, id);
+  code += "};\n\n";
+  return code;
+}
+
+
+// parameters passed from js, without the ones filled in by the handler
+int jsParamCount(const FunctionBase &function)
+{
+  int count = 0;
+  for (const Parameter &p : function.mParams)
+    count += p.paramType != ParamType::UserData;
+  return count;
+}
+
+
+// "a number", ... and the check for it, empty if there is nothing to check
+QString typeCheck(ParamType type, const QString &value, QString &expected)
+{
+  switch (type)
+  {
+    case ParamType::Boolean:
+      expected = "a boolean";
+      return QString("jerry_value_is_boolean(%1)").arg(value);
+
+    case ParamType::Number:
+      expected = "a number";
+      return QString("jerry_value_is_number(%1)").arg(value);
+
+    case ParamType::Enum:
+      expected = "an enumerator name or number";
+      return QString("(jerry_value_is_string(%1) || jerry_value_is_number(%1))").arg(value);
+
+    case ParamType::String:
+    case ParamType::CharString:
+      expected = "a string";
+      return QString("jerry_value_is_string(%1)").arg(value);
+
+    case ParamType::Pointer:
+    case ParamType::Struct:
+    case ParamType::StructPointer:
+    case ParamType::ClassPointer:
+    case ParamType::ClassReference:
+    case ParamType::ClassShared:
+    case ParamType::ClassUnique:
+    case ParamType::Container:
+      expected = "an object";
+      return QString("jerry_value_is_object(%1)").arg(value);
+
+    case ParamType::Callback:
+    case ParamType::CallbackPointer:
+      expected = "a function";
+      return QString("jerry_value_is_function(%1)").arg(value);
+
+    default:
+      return QString();
+  }
+}
+
+
+// the argument count check at the top of a handler
+QString argcCheck(const QString &name, int count, Validation level)
+{
+  switch (level)
+  {
+    case Validation::Debug:
+      return QString("  if (argc != %2)\n"
+                     "    throw std::string(\"%1 called with \") + std::to_string(argc) + \" arguments (must be %2)\";").arg(name).arg(count);
+
+    case Validation::Trusted:
+      return QString();
+
+    default:
+      return QString("  if (argc != %2)\n"
+                     "    throw std::string(\"%1: invalid argument count\");").arg(name).arg(count);
+  }
+}
+
+
+QString argcCheck(const Function &function, Validation level)
+{
+  return argcCheck(function.mName, jsParamCount(function), level);
+}
+
+
+// the checks of one argument, before it gets converted
+QString argumentCheck(const Function &function, const Parameter &p, int jsIndex, Validation level)
+{
+  const QString arg(QString("args[%1]").arg(jsIndex));
+
+  QString expected;
+  const QString check(typeCheck(p.paramType, arg, expected));
+  if (check.isEmpty() || level == Validation::Trusted)
+    return QString();
+
+  if (level != Validation::Debug)
+  {
+    QString code(QString("  if (!%1)\n"
+                         "    throw std::string(\"%2: parameter %3 must be %4\");\n").arg(check, function.mName).arg(jsIndex + 1).arg(expected));
+
+    // casting NaN, the infinities or out of range numbers to an integer type is undefined
+    if (p.paramType == ParamType::Number)
+    {
+      code += QString("  if (!_rtjs_number_fits<%1>(%2))\n").arg(p.mType, arg);
+      code += QString("    throw std::string(\"%1: parameter %2 must fit %3\");\n").arg(function.mName).arg(jsIndex + 1).arg(p.mType);
+    }
+    return code;
+  }
+
+  QString what(QString("%1: parameter %2").arg(function.mName).arg(jsIndex + 1));
+  if (!p.mName.isEmpty())
+    what += QString(" (%1)").arg(p.mName);
+
+  QString code;
+  code += QString("  if (!%1)\n").arg(check);
+  code += QString("    throw std::string(\"%1 must be %2, got \") + _rtjs_type_name(%3);\n").arg(what, expected, arg);
+
+  if (p.paramType == ParamType::Number)
+  {
+    code += QString("  if (!_rtjs_number_fits<%1>(%2))\n").arg(p.mType, arg);
+    code += QString("    throw std::string(\"%1 must fit %2, got \") + std::to_string(jerry_get_number_value(%3));\n").arg(what, p.mType, arg);
+  }
+
+  return code;
+}
+
+
+QString readFile(const QString &filename)
+{
+  QFile f(":/templates/" + filename);
+  if (!f.open(QIODevice::ReadOnly))
+  {
+    cerr << "cannot open resource file '" << filename.toStdString() << "': " << f.errorString().toStdString() << endl;
+    abort();
+  }
+  return f.readAll();
+}
+
+
+// parameter conversion and call of a handler, callee being what gets called with the parameters
+QString handlerBody(const Function &f, const QString &callee, Validation level)
+{
+  QString code;
+
+  // js argument index per parameter, userdata parameters take the one of their callback
+  QVector<int> jsIndices;
+  int jsIndex = 0;
+  for (const Parameter &p : qAsConst(f.mParams))
+    jsIndices += p.paramType == ParamType::UserData ? -1 : jsIndex++;
+
+
+  // get parameters
+  QStringList pns;
+  int pn = 0;
+  for (const Parameter &p : qAsConst(f.mParams))
+  {
+    QString getter;
+    const QString arg(QString("args[%1]").arg(jsIndices.at(pn)));
+
+    if (p.paramType != ParamType::UserData)
+      getter += argumentCheck(f, p, jsIndices.at(pn), level);
+
+    if (isValueType(p.paramType) || p.paramType == ParamType::Callback || p.paramType == ParamType::CharString)
+      getter += QString("  auto _param%1 = %2;\n").arg(pn).arg(fromJs(p.paramType, p.mType, arg));
+    else if (p.paramType == ParamType::CallbackPointer)
+      getter += QString("  auto _param%1 = &_rtjs_%2_trampoline;\n").arg(pn).arg(p.mType);
+    else if (p.paramType == ParamType::UserData)
+    {
+      if (f.mRetainCallback) // native code calls back after the call, it hands the userdata to rtjs::releaseCallback()
+        getter += QString("  auto _param%1 = (void *)new rtjs::FunctionRef(args[%2]);\n").arg(pn).arg(jsIndices.at(p.mCallbackParam));
+      else // called back during the call only, released when the handler returns
+      {
+        getter += QString("  rtjs::FunctionRef ref%1(args[%2]);\n").arg(pn).arg(jsIndices.at(p.mCallbackParam));
+        getter += QString("  auto _param%1 = (void *)&ref%1;\n").arg(pn);
+      }
+    }
+    else if (p.paramType == ParamType::StructPointer)
+    {
+      getter += QString("  void *param%1Ptr = nullptr;\n").arg(pn);
+      if (level == Validation::Trusted)
+        getter += QString("  jerry_get_object_native_pointer(%2, &param%1Ptr, &_rtjs_%3_view_info);\n").arg(pn).arg(arg, structDefs.value(p.mType).mId);
+      else
+      {
+        getter += QString("  if (!jerry_get_object_native_pointer(%2, &param%1Ptr, &_rtjs_%3_view_info))\n").arg(pn).arg(arg, structDefs.value(p.mType).mId);
+        getter += QString("    throw std::string(\"%1 view expected for parameter %2\");\n").arg(p.mType).arg(pn);
+      }
+      getter += QString("  auto *_param%1 = static_cast<%2 *>(param%1Ptr);\n").arg(pn).arg(p.mType);
+    }
+    else if (p.paramType == ParamType::ClassPointer || p.paramType == ParamType::ClassReference)
+    {
+      // upcast by a static offset if the wrapper is the one of a derived class
+      getter += QString("  auto *_param%1 = _rtjs_%2_native(%3);\n").arg(pn).arg(classDefs.value(p.mType).mId, arg);
+      if (level != Validation::Trusted)
+      {
+        getter += QString("  if (!_param%1)\n").arg(pn);
+        getter += QString("    throw std::string(\"%1 expected for parameter %2\");\n").arg(p.mType).arg(pn);
+      }
+    }
+    else if (p.paramType == ParamType::ClassShared)
+      getter += QString("  auto _param%1 = _rtjs_%2_shared(%3);\n").arg(pn).arg(classDefs.value(p.mType).mId, arg);
+    else if (p.paramType == ParamType::ClassUnique)
+      getter += QString("  auto _param%1 = _rtjs_%2_release(%3);\n").arg(pn).arg(classDefs.value(p.mType).mId, arg);
+    else if (p.paramType == ParamType::Pointer)
+    {
+      getter += QString("  auto jsParam%1 = %2;\n").arg(pn).arg(arg);
+      getter += QString("  void *param%1Ptr = nullptr;\n").arg(pn);
+      if (level == Validation::Trusted)
+        getter += QString("  jerry_get_object_native_pointer(jsParam%1, &param%1Ptr, &_rtjs_pointer_info) || jerry_get_object_native_pointer(jsParam%1, &param%1Ptr, nullptr);\n").arg(pn);
+      else
+      {
+        getter += QString("  if (!jerry_get_object_native_pointer(jsParam%1, &param%1Ptr, &_rtjs_pointer_info)\n").arg(pn);
+        getter += QString("      && !jerry_get_object_native_pointer(jsParam%1, &param%1Ptr, nullptr)) // made by the embedder\n").arg(pn);
+        getter += QString("    throw std::string(\"some handler called with no raw pointer behind it!\");\n");
+      }
+      getter += QString("  auto *_param%1 = static_cast<%2>(param%1Ptr);\n").arg(pn).arg(p.mType);
+    }
+    else
+      getter = "oopsgetter";
+
+    code += getter;
+
+    // converted containers, structs and strings are moved, not copied a second time
+    code += QString("  auto param%1 = std::move(_param%1);\n").arg(pn);
+
+    if (p.paramType == ParamType::CharString && p.mType == "const char *")
+      pns += QString("param%1.c_str()").arg(pn);
+    else if (p.paramType == ParamType::ClassReference)
+      pns += QString("*param%1").arg(pn);
+    else if (p.paramType == ParamType::ClassUnique)
+      pns += QString("std::move(param%1)").arg(pn);
+    else
+      pns += QString("param%1").arg(pn);
+    pn++;
+  }
+
+
+  // trampolines of function pointers return quietly after an overrun, report it once back from native code
+  bool callsBackByPointer = false;
+  for (const Parameter &p : qAsConst(f.mParams))
+    callsBackByPointer |= p.paramType == ParamType::CallbackPointer;
+  const QString overrunCheck(callsBackByPointer ? "  rtjs::ExecutionBudget::checkCurrent();\n" : "");
+
+  // call c/c++ function
+  if (f.mReturnType == ParamType::Unknown)
+    code += "  oopshandler\n";
+  else if (f.mAsync)
+  {
+    // the wrappers of raw object arguments are kept until the call is done, the gc would delete their objects
+    QStringList wrappers;
+    for (int i = 0; i < f.mParams.count(); i++)
+    {
+      if (f.mParams.at(i).paramType == ParamType::ClassPointer || f.mParams.at(i).paramType == ParamType::ClassReference)
+        wrappers += QString("jerry_acquire_value(args[%1])").arg(jsIndices.at(i));
+    }
+
+    code += readFile("async.tpl").arg(callee, pns.join(", "), returnToJs(f, "result->mValue"), wrappers.join(", "));
+  }
+  else if (f.mReturnType == ParamType::Void)
+  {
+    code += QString("  %1(%2);\n").arg(callee).arg(pns.join(", "));
+    code += overrunCheck;
+    code += "  return jerry_create_undefined();\n";
+  }
+  else
+  {
+    code += QString("  %1ret = %2(%3);\n").arg((f.mLazy && f.mBorrowed) || f.mReturnType == ParamType::ClassReference ? "auto &&" : "auto ").arg(callee).arg(pns.join(", "));
+    code += overrunCheck;
+    code += QString("  return %1;\n").arg(returnToJs(f, "ret"));
+  }
+
+  return code;
+}
+
+
+// > precompiled prefix headers
+
+// the prefix headers are included by a generated stub header, precompiled to <stub>.pch next to it.
+// parsing with "-include <stub>" then makes clang load the pch instead of lexing the prefix again
+// (cppast has no way to pass -include-pch). rebuilt when the configuration or any header it includes changes
+QString preparePch(const QStringList &prefixHeaders, const QStringList &includes, const QStringList &definitions, const QString &cacheDir)
+{
+  QString stubContent("// generated by rtjsgen, precompiled to the .pch next to this file\n");
+  for (const QString &header : prefixHeaders)
+  {
+    if (header.startsWith('<') || header.startsWith('"'))
+      stubContent += QString("#include %1\n").arg(header);
+    else
+      stubContent += QString("#include \"%1\"\n").arg(QFileInfo(header).absoluteFilePath());
+  }
+
+  QStringList args({ "-x", "c++-header", "-std=c++11", "-fPIC" }); // must match the parse configuration
+  for (const QString &include : includes)
+    args += "-I" + include;
+  for (const QString &definition : definitions)
+    args += "-D" + definition;
+
+  // one pch per configuration
+  const QByteArray key((stubContent + args.join('\n')).toUtf8());
+  const QString stubPath(QString("%1/prefix-%2.h").arg(cacheDir).arg(hashName(key, 0), 8, 16, QChar('0')));
+  const QString pchPath(stubPath + ".pch");
+  const QString depsPath(stubPath + ".deps");
+
+  QFileInfo pch(pchPath);
+  QFile deps(depsPath);
+  if (pch.exists() && deps.open(QIODevice::ReadOnly))
+  {
+    bool upToDate = true;
+    for (const QByteArray &dep : deps.readAll().split('\n'))
+    {
+      if (!dep.isEmpty() && QFileInfo(QString::fromUtf8(dep)).lastModified() > pch.lastModified())
+      {
+        upToDate = false;
+        break;
+      }
+    }
+
+    if (upToDate)
+    {
+      qWarning() << "(reusing precompiled header" << pchPath << ")";
+      return stubPath;
+    }
+    deps.close();
+  }
+
+  QDir().mkpath(cacheDir);
+  QFile stub(stubPath);
+  if (!stub.open(QIODevice::WriteOnly) || stub.write(stubContent.toUtf8()) < 0)
+  {
+    qWarning() << "cannot write" << stubPath;
+    return {};
+  }
+  stub.close();
+
+  qWarning() << "precompiling" << prefixHeaders << "to" << pchPath;
+
+  std::vector<QByteArray> argStrings;
+  std::vector<const char *> argv;
+  for (const QString &arg : qAsConst(args))
+    argStrings.push_back(arg.toUtf8());
+  for (const QByteArray &arg : argStrings)
+    argv.push_back(arg.constData());
+
+  CXIndex index = clang_createIndex(0, 1);
+  CXTranslationUnit tu = nullptr;
+  const QByteArray stubPathUtf8(stubPath.toUtf8());
+  CXErrorCode error = clang_parseTranslationUnit2(index, stubPathUtf8.constData(), argv.data(), (int)argv.size(), nullptr, 0,
+                                                  CXTranslationUnit_Incomplete | CXTranslationUnit_ForSerialization, &tu);
+
+  bool ok = error == CXError_Success;
+  for (unsigned i = 0; ok && i < clang_getNumDiagnostics(tu); i++)
+  {
+    CXDiagnostic diagnostic = clang_getDiagnostic(tu, i);
+    if (clang_getDiagnosticSeverity(diagnostic) >= CXDiagnostic_Error)
+    {
+      CXString text = clang_formatDiagnostic(diagnostic, clang_defaultDiagnosticDisplayOptions());
+      qWarning() << clang_getCString(text);
+      clang_disposeString(text);
+      ok = false;
+    }
+    clang_disposeDiagnostic(diagnostic);
+  }
+
+  QByteArray depList;
+  if (ok)
+  {
+    clang_getInclusions(tu, [](CXFile file, CXSourceLocation *, unsigned, CXClientData data)
+    {
+      CXString name = clang_getFileName(file);
+      *static_cast<QByteArray *>(data) += QByteArray(clang_getCString(name)) + '\n';
+      clang_disposeString(name);
+    }, &depList);
+
+    const QByteArray tmpPath((pchPath + ".tmp").toUtf8());
+    ok = clang_saveTranslationUnit(tu, tmpPath.constData(), clang_defaultSaveOptions(tu)) == CXSaveError_None
+        && ::rename(tmpPath.constData(), pchPath.toUtf8().constData()) == 0;
+  }
+
+  if (tu)
+    clang_disposeTranslationUnit(tu);
+  clang_disposeIndex(index);
+
+  if (!ok || !deps.open(QIODevice::WriteOnly) || deps.write(depList) < 0)
+  {
+    qWarning() << "cannot precompile" << prefixHeaders << "(parsing without)";
+    QFile::remove(pchPath);
+    return {};
+  }
+
+  return stubPath;
+}
+
+
+// a compilation database is the only way to pass -include through cppast
+bool writePchDatabase(const QString &cacheDir, const QStringList &sourceFiles, const QString &stubPath,
+                      const QStringList &includes, const QStringList &definitions)
+{
+  QStringList args({ "clang++", "-std=c++11", "-include", stubPath });
+  for (const QString &include : includes)
+    args += "-I" + include;
+  for (const QString &definition : definitions)
+    args += "-D" + definition;
+
+  QJsonArray commands;
+  for (const QString &filename : sourceFiles)
+  {
+    const QString path(QFileInfo(filename).absoluteFilePath());
+
+    QJsonObject command;
+    command["directory"] = QDir::currentPath();
+    command["file"] = path;
+    command["arguments"] = QJsonArray::fromStringList(QStringList(args) << "-c" << path);
+    commands += command;
+  }
+
+  QFile database(cacheDir + "/compile_commands.json");
+  return database.open(QIODevice::WriteOnly) && database.write(QJsonDocument(commands).toJson()) >= 0;
+}
+
+
+void setParseOptions(cppast::libclang_compile_config &config)
+{
+  cppast::compile_flags flags;
+  config.set_flags(cppast::cpp_standard::cpp_11, flags);
+
+  flags |= cppast::compile_flag::gnu_extensions;
+
+  config.enable_feature("PIC");
+  config.enable_feature("diagnostics-format=clang");
+}
+
+
+// generated handlers, appended header by header. with --stream they go to a file next to the
+// output right away instead of piling up in memory
+class HandlerSpool
 {
 public:
+  ~HandlerSpool()
+  {
+    if (mFile)
+      mFile->remove();
+  }
 
-};
+  bool open(const QString &path)
+  {
+    mFile.reset(new QFile(path));
+    return mFile->open(QIODevice::ReadWrite | QIODevice::Truncate);
+  }
 
+  HandlerSpool &operator+=(const QString &code)
+  {
+    if (mFile)
+      mFile->write(code.toUtf8());
+    else
+      mText += code;
+    return *this;
+  }
 
-class Ctor : public FunctionBase
-{
+  bool writeTo(QIODevice &out)
+  {
+    if (!mFile)
+    {
+      const QByteArray text(mText.toUtf8());
+      return out.write(text) == text.size();
+    }
 
-};
+    if (!mFile->seek(0))
+      return false;
 
+    while (!mFile->atEnd())
+    {
+      const QByteArray chunk(mFile->read(1 << 20));
+      if (chunk.isEmpty() || out.write(chunk) != chunk.size())
+        return false;
+    }
+    return true;
+  }
 
-class ClassDef
-{
-public:
-  bool mValid = false;
-  QString mName;
-  QVector<Ctor> mCtors;
-  QVector<MemberFunction> mMemberFunctions;
-  QVector<StaticFunction> mStaticFunctions;
+private:
+  std::unique_ptr<QFile> mFile;
+  QString mText;
 };
 
 
-void getReturnType(Function &function, const cppast::cpp_type &returnType)
+// head, handlers and tail, through a temporary file compared in chunks with the current output:
+// an unchanged output keeps its timestamp, nothing depending on it gets rebuilt
+bool writeOutput(const QString &output, const QByteArray &head, HandlerSpool &handlers, const QByteArray &tail)
 {
-  switch (returnType.kind())
+  const QString temporary(output + ".new");
+  QFile out(temporary);
+  if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate) || out.write(head) != head.size()
+      || !handlers.writeTo(out) || out.write(tail) != tail.size())
   {
-    case cppast::cpp_type_kind::builtin_t:
-    {
-      auto& builtin = static_cast<const cppast::cpp_builtin_type &>(returnType);
-
-      switch (builtin.builtin_type_kind())
-      {
-        case cppast::cpp_builtin_type_kind::cpp_bool:
-        {
-          function.mReturnType = ParamType::Boolean;
-          function.mReturnTypeString = "bool";
-          break;
-        }
-
-        default:
-        {
-          function.mReturnTypeString = "builtinoops";
-          break;
-        }
-      }
-
+    qWarning() << "cannot write" << temporary << out.errorString();
+    out.remove();
+    return false;
+  }
+  out.close();
 
-      break;
-    }
+  QFile current(output);
+  bool same = current.open(QIODevice::ReadOnly) && current.size() == QFileInfo(temporary).size() && out.open(QIODevice::ReadOnly);
+  while (same && !current.atEnd())
+  {
+    const QByteArray chunk(current.read(1 << 20));
+    same = !chunk.isEmpty() && out.read(chunk.size()) == chunk;
+  }
+  current.close();
+  out.close();
 
-    case cppast::cpp_type_kind::pointer_t:
-    {
-      function.mReturnType = ParamType::Pointer;
-      function.mReturnTypeString = "auto *";
-      break;
-    }
+  if (same)
+  {
+    qWarning() << "(" << output << "unchanged )";
+    QFile::remove(temporary);
+    return true;
+  }
 
-    default:
-    {
-      function.mReturnTypeString = "defaultoops";
-      break;
-    }
+  if (std::rename(QFile::encodeName(temporary).constData(), QFile::encodeName(output).constData()) != 0) // atomically
+  {
+    qWarning() << "cannot replace" << output;
+    return false;
   }
+  return true;
 }
 
 
-// TODO: accept cpp_function_base instead of params
-void getFunctionParameters(FunctionBase &function, cppast::detail::iteratable_intrusive_list<cppast::cpp_function_parameter> params)
+// > daemon
+
+// parsed headers kept by rtjsgen --daemon between generations of one output
+class ParseCache
 {
-  std::for_each(params.begin(), params.end(), [&function](const cppast::cpp_function_parameter &param)
+public:
+  class Entry
   {
-    QString paramName(QString::fromStdString(param.name()));
-    //qWarning() << "param type int" << (int)param.type().kind() << "for param with name" << paramName;
-
-    QString typeString;
-    ParamType type = ParamType::Unknown;
-    switch (param.type().kind())
-    {
-      case cppast::cpp_type_kind::builtin_t:
-      {
-        auto& builtin = static_cast<const cppast::cpp_builtin_type &>(param.type());
-        type = ParamType::JSCompatible;
+  public:
+    std::unique_ptr<cppast::cpp_entity_index> mIndex; // per file, so a reparse leaves no stale entities behind
+    std::unique_ptr<cppast::cpp_file> mFile;
+    QStringList mDependencies; // absolute paths of the header and of everything it includes
+  };
 
-        switch (builtin.builtin_type_kind())
-        {
-          case cppast::cpp_builtin_type_kind::cpp_bool:
-          {
-            typeString = "bool";
-            type = ParamType::Boolean;
-            break;
-          }
+  const cppast::cpp_file *find(const QString &filename) const
+  {
+    auto it = mEntries.find(QFileInfo(filename).absoluteFilePath());
+    return it != mEntries.end() ? it->second.mFile.get() : nullptr;
+  }
 
-          // etc....
+  void store(const QString &filename, std::unique_ptr<cppast::cpp_entity_index> index, std::unique_ptr<cppast::cpp_file> file,
+             const QStringList &includePaths)
+  {
+    Entry &entry(storeDependencies(filename, *file, includePaths));
+    entry.mIndex = std::move(index);
+    entry.mFile = std::move(file);
+  }
 
-          default:
-          {
-            typeString = "auto /* built-in unknown */"; // oops, try to hide the failure :)
-            break;
-          }
-        }
+  // just what invalidates filename, for --stream which doesn't keep any parsed header
+  Entry &storeDependencies(const QString &filename, const cppast::cpp_file &file, const QStringList &includePaths)
+  {
+    Entry &entry(mEntries[QFileInfo(filename).absoluteFilePath()]);
+    entry.mDependencies = QStringList(QFileInfo(filename).absoluteFilePath());
+    entry.mIndex.reset();
+    entry.mFile.reset();
 
-        break;
+    for (const cppast::cpp_entity &e : file)
+    {
+      if (e.kind() == cppast::cpp_entity_kind::include_directive_t)
+      {
+        const QString path(QString::fromStdString(static_cast<const cppast::cpp_include_directive &>(e).full_path()));
+        if (!path.isEmpty())
+          addDependency(QFileInfo(path).absoluteFilePath(), includePaths, entry.mDependencies);
       }
+    }
 
-      case cppast::cpp_type_kind::pointer_t:
-      {
-        //std::cerr << "POINTER KIND: " << (int)param.kind() << std::endl;
-        //std::cerr << "POINTER TYPE KIND: " << (int)param.type().kind() << std::endl;
+    return entry;
+  }
 
-        auto& pointer = static_cast<const cppast::cpp_pointer_type &>(param.type());
-        //std::cerr << "POINTER POINTEE KIND: " << (int)pointer.pointee().kind() << std::endl;
+  // drops the headers depending on path, returns whether there were any
+  bool invalidate(const QString &path)
+  {
+    bool affected = false;
+    for (auto it = mEntries.begin(); it != mEntries.end();)
+    {
+      if (it->second.mDependencies.contains(path))
+      {
+        it = mEntries.erase(it);
+        affected = true;
+      }
+      else
+        ++it;
+    }
+    return affected;
+  }
 
-        if (pointer.pointee().kind() == cppast::cpp_type_kind::builtin_t)
-        {
-          auto& builtin = static_cast<const cppast::cpp_builtin_type &>(pointer.pointee());
-          // cpp_builtin_type_kind \/
-          typeString = QString::fromUtf8(cppast::to_string(builtin.builtin_type_kind()));
-          //std::cerr << "builtin => " << typeString.toStdString().c_str() << "(" << (int)builtin.builtin_type_kind() << ")" << std::endl;
+  QStringList dependencies() const
+  {
+    QStringList paths;
+    for (const auto &entry : mEntries)
+      paths += entry.second.mDependencies;
+    paths.removeDuplicates();
+    return paths;
+  }
 
-        }
-//        else ( pointer.pointee().kind() == cppast::cpp_type_kind::unexposed_t )
-//      {
-//    cpp_unexposed_type
-//    }
+  void clear()
+  {
+    mEntries.clear();
+  }
 
+private:
+  // cppast only has the include directives of the parsed file, the included headers get scanned for
+  // theirs. conditional ones are followed as well, and only what the directory of the including file
+  // or the include paths resolve, which leaves out the headers of the system further down
+  static void addDependency(const QString &path, const QStringList &includePaths, QStringList &dependencies)
+  {
+    static const QRegularExpression includeRe("^\\s*#\\s*include\\s*([<\"])([^>\"]+)[>\"]", QRegularExpression::MultilineOption);
 
+    if (dependencies.contains(path))
+      return;
+    dependencies += path;
 
-        //pointer.kind()
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+      return;
 
+    QRegularExpressionMatchIterator it(includeRe.globalMatch(QString::fromUtf8(file.readAll())));
+    while (it.hasNext())
+    {
+      const QRegularExpressionMatch match(it.next());
 
-        typeString = QString("%1 *").arg(typeString);
-        //typeString = "auto *"; // TODO: un-auto
-        type = ParamType::Pointer;
-        break;
-      }
+      QStringList dirs(includePaths);
+      if (match.captured(1) == "\"")
+        dirs.prepend(QFileInfo(path).absolutePath());
 
-      default:
+      for (const QString &dir : qAsConst(dirs))
       {
-        typeString = "auto /* unknown */"; // hide our failure
-        type = ParamType::Object; // ???
-        break;
+        const QFileInfo included(QDir(dir), match.captured(2));
+        if (included.isFile())
+        {
+          addDependency(included.absoluteFilePath(), includePaths, dependencies);
+          break;
+        }
       }
     }
-
-
-    function.mParams += { paramName, typeString, type };
-    //qWarning() << "parameter" << paramName << "is of type" << typeString;
-  });
-
-  //qWarning() << "???" << function.mParams.count();
-}
-
-
-QString readFile(const QString &filename)
-{
-  QFile f(":/templates/" + filename);
-  if (!f.open(QIODevice::ReadOnly))
-  {
-    cerr << "cannot open resource file '" << filename.toStdString() << "': " << f.errorString().toStdString() << endl;
-    abort();
   }
-  return f.readAll();
-}
+
+  std::map<QString, Entry> mEntries;
+};
 
 
-int main(int argc, char **argv)
+// one run over the command line arguments (args.at(0) being the program), reusing and filling cache if given
+int generate(const QStringList &args, ParseCache *cache)
 {
-  Q_INIT_RESOURCE(res);
-  QCoreApplication app(argc, argv);
+  // from a previous generation of the daemon
+  enumDefs.clear();
+  structDefs.clear();
+  classDefs.clear();
+  containerDefs.clear();
+  callbackDefs.clear();
 
   cppast::libclang_compile_config config;
 
-  const QStringList args(app.arguments());
-
   if (args.count() < 2)
   {
-    qWarning() << "usage:" << args.at(0) << "<header files> -O <output file> [-I <include paths ...>)] [-D <definitions ...>]";
+    qWarning() << "usage:" << args.at(0) << "<header files> -O <output file> [-I <include paths ...>)] [-D <definitions ...>] [-A <async functions ...>]"
+               << "[-F <file globs ...>] [-N <namespaces ...>] [-X <excluded name globs ...>] [--export-only] [--pch <prefix headers ...>] [--table] [--audit]"
+               << "[--validation debug|checked|trusted] [--stream] [--server <daemon socket>]";
     return -1;
   }
 
@@ -251,17 +1870,59 @@ int main(int argc, char **argv)
     Include,
     Definition,
     Output,
+    Async,
+    Files,
+    Namespaces,
+    Excludes,
+    Pch,
+    Validation,
   };
 
   QStringList sourceFiles;
   QStringList includes;
+  QStringList asyncFunctions; // in addition to the ones marked with [[rtjs::async]]
   QString output;
-  static QStringList paramSwitches({ "-I", "-D", "-O" });
+  QStringList definitions;
+  QStringList prefixHeaders; // precompiled once, implicitly included when parsing
+  bool audit = false; // reference accounting per binding, see rtjs/audit.h
+  bool tableBindings = false; // constexpr descriptors + rtjs/bindings.h instead of a handler per function
+  Validation validation = Validation::Checked; // for functions without [[rtjs::validation(level)]]
+  bool stream = false; // handlers spooled to disk header by header, no parsed header kept
+  ScopeFilter scope;
+  // Qt meta object boilerplate
+  for (const char *name : { "metaObject", "qt_metacast", "staticMetaObject", "tr", "trUtf8", "qt_static_metacall" })
+    scope.mExcludes += ScopeFilter::glob(name);
+
+  static QStringList paramSwitches({ "-I", "-D", "-O", "-A", "-F", "-N", "-X", "--pch", "--validation" });
   ArgType argType = ArgType::Skip;
   for (const QString &arg : args)
   {
     qWarning() << "param" << arg;
 
+    if (arg == "--export-only")
+    {
+      scope.mExportOnly = true;
+      continue;
+    }
+
+    if (arg == "--table")
+    {
+      tableBindings = true;
+      continue;
+    }
+
+    if (arg == "--audit")
+    {
+      audit = true;
+      continue;
+    }
+
+    if (arg == "--stream")
+    {
+      stream = true;
+      continue;
+    }
+
     switch (paramSwitches.indexOf(arg))
     {
       case 0:
@@ -281,6 +1942,42 @@ int main(int argc, char **argv)
         argType = ArgType::Output;
         continue;
       }
+
+      case 3:
+      {
+        argType = ArgType::Async;
+        continue;
+      }
+
+      case 4:
+      {
+        argType = ArgType::Files;
+        continue;
+      }
+
+      case 5:
+      {
+        argType = ArgType::Namespaces;
+        continue;
+      }
+
+      case 6:
+      {
+        argType = ArgType::Excludes;
+        continue;
+      }
+
+      case 7:
+      {
+        argType = ArgType::Pch;
+        continue;
+      }
+
+      case 8:
+      {
+        argType = ArgType::Validation;
+        continue;
+      }
     }
 
     switch (argType)
@@ -296,7 +1993,7 @@ int main(int argc, char **argv)
       {
         //qWarning() << "(added as source)";
 
-        if (arg.endsWith(".h") || args.endsWith(".hpp") || args.endsWith(".hxx"))
+        if (arg.endsWith(".h") || arg.endsWith(".hpp") || arg.endsWith(".hxx"))
           sourceFiles += arg;
         else
           qWarning() << "(not adding non-header file" << arg << ")";
@@ -311,6 +2008,51 @@ int main(int argc, char **argv)
         break;
       }
 
+      case ArgType::Async:
+      {
+        asyncFunctions += arg.split(QRegularExpression("[;,]"), Qt::SkipEmptyParts);
+        break;
+      }
+
+      case ArgType::Files:
+      {
+        for (const QString &file : arg.split(QRegularExpression("[;,]"), Qt::SkipEmptyParts))
+          scope.mFiles += ScopeFilter::glob(file);
+        break;
+      }
+
+      case ArgType::Namespaces:
+      {
+        for (QString ns : arg.split(QRegularExpression("[;,]"), Qt::SkipEmptyParts))
+        {
+          if (ns.startsWith("::"))
+            ns.remove(0, 2);
+          scope.mNamespaces += ns;
+        }
+        break;
+      }
+
+      case ArgType::Excludes:
+      {
+        for (const QString &exclude : arg.split(QRegularExpression("[;,]"), Qt::SkipEmptyParts))
+          scope.mExcludes += ScopeFilter::glob(exclude);
+        break;
+      }
+
+      case ArgType::Pch:
+      {
+        prefixHeaders += arg.split(QRegularExpression("[;,]"), Qt::SkipEmptyParts);
+        break;
+      }
+
+      case ArgType::Validation:
+      {
+        const Validation level = parseValidation(arg);
+        if (level != Validation::Default)
+          validation = level;
+        break;
+      }
+
       case ArgType::Include:
       {
         includes = arg.split(";", Qt::SkipEmptyParts);
@@ -331,6 +2073,9 @@ int main(int argc, char **argv)
         QStringList defs(arg.split(";"));
         for (const QString &def : qAsConst(defs))
         {
+          if (!def.isEmpty())
+            definitions += def;
+
           QStringList x(def.split("="));
           if (x.count() == 1)
             config.define_macro(x.at(0).toStdString(), {});
@@ -352,6 +2097,29 @@ int main(int argc, char **argv)
     return -1;
   }
 
+  // the table handler is rtjs/bindings.h code, which the audit doesn't count
+  if (audit && tableBindings)
+  {
+    qWarning() << "(--audit counts generated handlers only, ignoring --table)";
+    tableBindings = false;
+  }
+
+  // filtered before parsing, headers not selected don't cost anything
+  for (int i = sourceFiles.count() - 1; i >= 0; i--)
+  {
+    if (!scope.acceptsFile(sourceFiles.at(i)))
+    {
+      qWarning() << "(skipping filtered out file" << sourceFiles.at(i) << ")";
+      sourceFiles.removeAt(i);
+    }
+  }
+
+  if (sourceFiles.isEmpty())
+  {
+    qWarning() << "no source files left after filtering";
+    return -1;
+  }
+
 
   if (output.isEmpty())
   {
@@ -360,13 +2128,17 @@ int main(int argc, char **argv)
   }
 
 
-  cppast::compile_flags flags;
-  config.set_flags(cppast::cpp_standard::cpp_11, flags);
+  setParseOptions(config);
 
-  flags |= cppast::compile_flag::gnu_extensions;
+  std::unique_ptr<cppast::libclang_compilation_database> pchDatabase;
+  if (!prefixHeaders.isEmpty())
+  {
+    const QString cacheDir(QFileInfo(output).absolutePath() + "/rtjs_pch");
+    const QString stubPath(preparePch(prefixHeaders, includes, definitions, cacheDir));
 
-  config.enable_feature("PIC");
-  config.enable_feature("diagnostics-format=clang");
+    if (!stubPath.isEmpty() && writePchDatabase(cacheDir, sourceFiles, stubPath, includes, definitions))
+      pchDatabase.reset(new cppast::libclang_compilation_database(cacheDir.toStdString()));
+  }
 
   cppast::stderr_diagnostic_logger logger;
   logger.set_verbose(true);
@@ -375,35 +2147,63 @@ int main(int argc, char **argv)
 
   //auto file = parse_file(config, logger, args.at(1), 1);
 
-  cppast::cpp_entity_index idx;
   // the parser is used to parse the entity
   // there can be multiple parser implementations
   cppast::libclang_parser parser(type_safe::ref(logger));
 
 
 
-  QMap<QString, ClassDef> classDefs;
-
+  // what the functions of all headers contribute to the output, generated header by header
+  HandlerSpool handlers;
+  if (stream && !handlers.open(output + ".handlers"))
+  {
+    qWarning() << "cannot spool to" << output + ".handlers";
+    return -1;
+  }
+  QString registrations; // function.tpl per function, for init
+  QString table; // --table: descriptors instead of handlers
+  QString tableFunctions; // the function pointers the descriptors point to
+  bool async = false;
 
 
   for (const QString &filename : qAsConst(sourceFiles))
   {
     //qWarning() << "parsing file" << filename;
 
-    // parse the file
-    auto file = parser.parse(idx, filename.toStdString(), config);
-    if (parser.error())
+    // parse the file, unless the daemon still has it
+    std::unique_ptr<cppast::cpp_entity_index> index;
+    std::unique_ptr<cppast::cpp_file> parsedFile;
+    const cppast::cpp_file *file = cache ? cache->find(filename) : nullptr;
+    if (!file)
     {
-      qDebug() << "parser error";
-      return -1;
+      cppast::libclang_compile_config fileConfig(config);
+      if (pchDatabase)
+      {
+        fileConfig = cppast::libclang_compile_config(*pchDatabase, QFileInfo(filename).absoluteFilePath().toStdString());
+        setParseOptions(fileConfig);
+      }
+
+      index.reset(new cppast::cpp_entity_index);
+      parsedFile = parser.parse(*index, filename.toStdString(), fileConfig);
+      if (parser.error())
+      {
+        qDebug() << "parser error";
+        return -1;
+      }
+
+      file = parsedFile.get();
+      if (cache && !stream)
+        cache->store(filename, std::move(index), std::move(parsedFile), includes);
     }
+    else
+      qWarning() << "(reusing parsed" << filename << ")";
 
 
     ClassDef currentClass;
     QVector<Function> functions;
 
 
-    cppast::visit(static_cast<const cppast::cpp_file &>(*file), [&](const cppast::cpp_entity& e, cppast::visitor_info info)
+    cppast::visit(*file, [&](const cppast::cpp_entity& e, cppast::visitor_info info)
     {
       qWarning() << "visiting entity" << QString::fromStdString(e.name()) << "kind =" << (int)e.kind();
 
@@ -427,26 +2227,109 @@ int main(int argc, char **argv)
 //          return false;
 //      }
 
-      // cppast::cpp_file   ..... ka.... check only THIS file !!
+      // cppast only reports the entities of the parsed file itself, included headers are not visited.
+      // filtered out containers are not entered at all, so nothing below them is looked at
+      if (info.event != cppast::visitor_info::container_entity_exit && !scope.accepts(e))
+      {
+        qWarning() << "(filtered out)";
+        return info.event != cppast::visitor_info::container_entity_enter; // false would end the visit for leaves
+      }
 
-      static QStringList ignoreFunctions({ "metaObject", "qt_metacast", "staticMetaObject", "tr", "trUtf8", "qt_static_metacall" });
+      if (e.kind() == cppast::cpp_entity_kind::namespace_t)
+        return true;
 
 
-      if (currentClass.mValid && info.event == cppast::visitor_info::container_entity_exit)
+      if (currentClass.mValid && info.event == cppast::visitor_info::container_entity_exit
+          && e.kind() == cppast::cpp_entity_kind::class_t && QString::fromStdString(cppast::full_name(e)) == currentClass.mName) // not for nested enums, namespaces, etc.
       {
         qWarning() << "class def for"<<currentClass.mName<<"done!";
-        classDefs.insert(currentClass.mName, currentClass);
+
+        if (currentClass.mPod && !currentClass.mFields.isEmpty())
+        {
+          qWarning() << "(marshalled by value as POD struct)";
+          structDefs.insert(currentClass.mName, currentClass);
+        }
+        else
+          classDefs.insert(currentClass.mName, currentClass);
+
         currentClass = {};
       }
 
 
+      if (e.kind() == cppast::cpp_entity_kind::enum_t && info.event == cppast::visitor_info::container_entity_enter)
+      {
+        auto& _enum = static_cast<const cppast::cpp_enum &>(e);
+
+        if (!_enum.is_definition())
+          return true;
+
+        static const QRegularExpression nonIdentifier("[^A-Za-z0-9]+");
+
+        EnumDef enumDef;
+        enumDef.mName = QString::fromStdString(cppast::full_name(_enum));
+        enumDef.mId = QString(enumDef.mName).replace(nonIdentifier, "_");
+
+        for (const cppast::cpp_enum_value &value : _enum)
+          enumDef.mValues += QString::fromStdString(value.name());
+
+        qWarning() << "enum" << enumDef.mName << enumDef.mValues;
+        enumDefs.insert(enumDef.mName, enumDef);
+        return true;
+      }
+
+
+      // nested classes aren't wrapped, not entering them keeps their members off the enclosing class
+      if (e.kind() == cppast::cpp_entity_kind::class_t && info.event == cppast::visitor_info::container_entity_enter && currentClass.mValid)
+      {
+        qWarning() << "(not wrapping nested class" << QString::fromStdString(cppast::full_name(e)) << ")";
+        return false;
+      }
+
       if (e.kind() == cppast::cpp_entity_kind::class_t && info.event == cppast::visitor_info::container_entity_enter && !currentClass.mValid)
       {
         auto& _class = static_cast<const cppast::cpp_class &>(e);
 
+        static const QRegularExpression nonIdentifier("[^A-Za-z0-9]+");
+
         currentClass.mValid = true;
-        currentClass.mName = QString::fromStdString(_class.name());
+        currentClass.mName = QString::fromStdString(cppast::full_name(_class));
+        currentClass.mId = QString(currentClass.mName).replace(nonIdentifier, "_");
+        currentClass.mPod = _class.bases().empty();
         qWarning() << "new class" << currentClass.mName;
+
+        for (const cppast::cpp_base_class &base : _class.bases())
+        {
+          const QString spelling(QString::fromStdString(base.name()));
+          const QString qualified(qualifiedName(classDefs, spelling));
+          const QString baseName(qualified.isEmpty() ? spelling : qualified);
+          if (base.access_specifier() == cppast::cpp_public && !base.is_virtual())
+            currentClass.mBases += baseName;
+          else
+            qWarning() << "(not inheriting from" << baseName << ", only public non-virtual bases have a static offset)";
+        }
+      }
+      else if (e.kind() == cppast::cpp_entity_kind::member_variable_t && currentClass.mValid)
+      {
+        auto &member = static_cast<const cppast::cpp_member_variable &>(e);
+
+        Field field;
+        field.mName = QString::fromStdString(member.name());
+        field.mParamType = getType(member.type(), field.mType);
+        field.mConst = member.type().kind() == cppast::cpp_type_kind::cv_qualified_t
+            && cppast::is_const(static_cast<const cppast::cpp_cv_qualified_type &>(member.type()).cv_qualifier());
+
+        qWarning() << "field" << field.mName << "of type" << field.mType << "for class" << currentClass.mName;
+
+        if (info.access != cppast::cpp_public || field.mConst
+            || (field.mParamType != ParamType::Boolean && field.mParamType != ParamType::Number && field.mParamType != ParamType::Enum))
+          currentClass.mPod = false;
+
+        if (info.access == cppast::cpp_public)
+          currentClass.mFields += field;
+      }
+      else if (e.kind() == cppast::cpp_entity_kind::bitfield_t && currentClass.mValid)
+      {
+        currentClass.mPod = false; // no offsetof() for bitfields
       }
       else if (e.kind() == cppast::cpp_entity_kind::constructor_t && currentClass.mValid)
       {
@@ -457,49 +2340,65 @@ int main(int argc, char **argv)
         Ctor _ctor;
         getFunctionParameters(_ctor, ctor.parameters());
 
+        currentClass.mPod = false;
+
         currentClass.mCtors += _ctor;
       }
+      else if (e.kind() == cppast::cpp_entity_kind::destructor_t && currentClass.mValid)
+      {
+        auto &dtor = static_cast<const cppast::cpp_destructor &>(e);
+        currentClass.mVirtualDtor = cppast::is_virtual(dtor.virtual_info());
+      }
       else if (e.kind() == cppast::cpp_entity_kind::member_function_t && currentClass.mValid)
       {
         QString memberFunctionName(QString::fromStdString(e.name()));
 
-        qWarning() << "member function"<<memberFunctionName<<"for class" << currentClass.mName;
-
-        if (ignoreFunctions.indexOf(memberFunctionName) != -1)
-        {
-          qWarning() << "(ignoring)";
+        // only what the handlers can call
+        auto &member = static_cast<const cppast::cpp_member_function&>(e);
+        if (info.access != cppast::cpp_public || memberFunctionName.startsWith("operator") || member.body_kind() == cppast::cpp_function_deleted)
           return true;
-        }
 
-        auto &member = static_cast<const cppast::cpp_member_function&>(e);
+        // methods need the object behind a wrapper, a copy has none
+        if (currentClass.mPod)
+          qWarning() << "(" << currentClass.mName << "has methods, wrapped instead of marshalled by value )";
+        currentClass.mPod = false;
+
+        qWarning() << "member function"<<memberFunctionName<<"for class" << currentClass.mName;
 
         MemberFunction memberFunction;
         getFunctionParameters(memberFunction, member.parameters());
-        getReturnType(memberFunction, member.return_type());
+        getReturnType(memberFunction, member.return_type(), e);
         memberFunction.mName = memberFunctionName;
+        memberFunction.mValidation = getValidation(e);
+        memberFunction.mRetainCallback = cppast::has_attribute(e, "rtjs::retain_callback").has_value();
 
-        currentClass.mMemberFunctions += memberFunction;
+        if (isCallable(memberFunction))
+          currentClass.mMemberFunctions += memberFunction;
+        else
+          qWarning() << "(not exposing" << memberFunctionName << ", unsupported parameter or return type)";
       }
       else if (e.kind() == cppast::cpp_entity_kind::function_t && currentClass.mValid) // class static
       {
         QString staticFunctionName(QString::fromStdString(e.name()));
 
-        qWarning() << "static function"<<staticFunctionName<<"for class" << currentClass.mName;
-
-        if (ignoreFunctions.indexOf(staticFunctionName) != -1)
-        {
-          qWarning() << "(ignoring)";
+        if (info.access != cppast::cpp_public || static_cast<const cppast::cpp_function &>(e).body_kind() == cppast::cpp_function_deleted)
           return true;
-        }
+
+        qWarning() << "static function"<<staticFunctionName<<"for class" << currentClass.mName;
 
         auto &_static = static_cast<const cppast::cpp_function &>(e);
 
         StaticFunction staticFunction;
         getFunctionParameters(staticFunction, _static.parameters());
-        getReturnType(staticFunction, _static.return_type());
+        getReturnType(staticFunction, _static.return_type(), e);
         staticFunction.mName = staticFunctionName;
+        staticFunction.mValidation = getValidation(e);
+        staticFunction.mRetainCallback = cppast::has_attribute(e, "rtjs::retain_callback").has_value();
 
-        currentClass.mStaticFunctions += staticFunction;
+        if (isCallable(staticFunction))
+          currentClass.mStaticFunctions += staticFunction;
+        else
+          qWarning() << "(not exposing" << staticFunctionName << ", unsupported parameter or return type)";
 
         //currentClass.mStaticFunctions += { QString::fromStdString(e.name()), {} };
       }
@@ -518,10 +2417,16 @@ int main(int argc, char **argv)
 
           qWarning() << "param count" << function.mParams.count();
 
-          getReturnType(function, _function.return_type());
+          getReturnType(function, _function.return_type(), e);
           function.mName = functionName;
-
-          functions += function;
+          function.mAsync = asyncFunctions.contains(functionName) || cppast::has_attribute(e, "rtjs::async");
+          function.mValidation = getValidation(e);
+          function.mRetainCallback = cppast::has_attribute(e, "rtjs::retain_callback").has_value();
+
+          if (isCallable(function))
+            functions += function;
+          else
+            qWarning() << "(not exposing" << functionName << ", unsupported parameter or return type)";
         }
       }
 
@@ -582,259 +2487,802 @@ int main(int argc, char **argv)
     });
 
 
+    // > functions
+    for(const Function &f : qAsConst(functions))
+    {
+      async |= f.mAsync;
 
+      if (tableBindings && isTableCompatible(f))
+      {
+        tableFunctions += QString("static constexpr decltype(&%1) _rtjs_%1_function = &%1;\n").arg(f.mName);
+        table += QString("  { \"%1\", &rtjs::Signature<decltype(%1)>::handler, &_rtjs_%1_function },\n").arg(f.mName);
+        continue;
+      }
 
+      registrations += readFile("function.tpl").arg(f.mName).arg(f.mName).arg("glob_obj");
+    }
 
-    // init
-    QString content;
-
-    // > functions
+    // > function handlers
     for(const Function &f : qAsConst(functions))
     {
-      content += readFile("function.tpl").arg(f.mName).arg(f.mName).arg("glob_obj");
+      const QString &fnName(f.mName);
+      if (tableBindings && isTableCompatible(f))
+        continue;
+
+      qWarning() << "handler for function" << f.mName;
+
+      const Validation level = f.mValidation == Validation::Default ? validation : f.mValidation;
+      handlers += readFile("handler1.tpl").arg(f.mName).arg(argcCheck(f, level));
+      handlers += handlerBody(f, fnName, level);
+      handlers += "\n}\n\n";
     }
 
 
-#define s QString
+    // only the model of the headers parsed so far is kept (enums, structs, containers, callbacks, classes)
+    if (cache && stream)
+      cache->storeDependencies(filename, *file, includes);
+  }
 
-    // > classes
-    for (const ClassDef &c : qAsConst(classDefs))
+
+  // init
+  QString content(registrations);
+  QString cleanup; // releases what content creates and keeps, in reverse order
+
+  // > enums
+  QString types; // converters for enums, structs and containers, callback trampolines
+  for (const EnumDef &en : qAsConst(enumDefs))
+  {
+    int tableSize;
+    quint32 seed;
+    if (!findPerfectHash(en.mValues, tableSize, seed))
     {
-//      if (c.mStaticFunctions.isEmpty()) // no need for global definitions for nen-static members
-//        continue;
+      qWarning() << "cannot find a perfect hash for enum" << en.mName;
+      return -1;
+    }
+
+    // empty slots can never match as no utf8 string is that long
+    QStringList slotLines;
+    for (int i = 0; i < tableSize; i++)
+      slotLines += QString("  { \"\", (jerry_size_t)-1, %1() },\n").arg(en.mName);
 
-      QString classHandler;
-      const QString &className(c.mName);
+    int maxLength = 1;
+    QStringList values;
+    QString toJs;
+    for (int i = 0; i < en.mValues.count(); i++)
+    {
+      const QString &value(en.mValues.at(i));
+      const QByteArray name(value.toUtf8());
 
-      qWarning() << "handler for class" << className;
+      slotLines[hashName(name, seed) & (tableSize - 1)] = QString("  { \"%1\", %2, %3::%1 },\n").arg(value).arg(name.size()).arg(en.mName);
+      maxLength = qMax(maxLength, name.size());
 
-      classHandler += "\n";
-      classHandler += "  // class\n";
-      classHandler += "  {\n"; // scoped class
-      classHandler += "    auto classObj = jerry_create_object();\n\n";
+      values += QString("%1::%2").arg(en.mName, value);
+      toJs += QString("  if (value == %1::%2)\n    return jerry_acquire_value(_rtjs_%3_names[%4]);\n").arg(en.mName, value, en.mId).arg(i);
+      content += QString("  _rtjs_%1_names[%2] = jerry_create_string_sz((const jerry_char_t *)\"%3\", %4);\n").arg(en.mId).arg(i).arg(value).arg(name.size());
+      cleanup.prepend(QString("  jerry_release_value(_rtjs_%1_names[%2]);\n").arg(en.mId).arg(i));
+    }
 
-      //int ctorn = 0;
-      // TODO: don't create ctor if ctor deleted or private
-      for (int ctorn = 0; (ctorn < c.mCtors.count() || ctorn == 0) /* at least one ctor! */; ctorn++)//const Ctor &ctor : qAsConst(c.mCtors))
-      {
-        classHandler += s("    {\n");
-        classHandler += s("      auto ctor = jerry_create_external_function(_rtjs_%1_ctor%2_handler);\n").arg(className).arg(ctorn);
-        classHandler += s("      auto ctorName = jerry_create_string((const jerry_char_t *)\"ctor%1\");\n").arg(ctorn);
-        classHandler += s("      auto prop = jerry_set_property(classObj, ctorName, ctor);\n");
-        classHandler += s("    }\n");
+    types += readFile("enum.tpl").arg(en.mName, en.mId).arg(tableSize).arg(slotLines.join(""))
+        .arg(qMax(en.mValues.count(), 1)).arg(maxLength).arg(seed).arg(tableSize - 1).arg(toJs)
+        .arg(values.isEmpty() ? QString("%1()").arg(en.mName) : values.join(", "));
+  }
 
-        //ctorn++;
-      }
+  // > structs
+  for (const ClassDef &st : qAsConst(structDefs))
+  {
+    const QString &structName(st.mName);
+    const QString &structId(st.mId);
+    QString toJsFields;
+    QString fromJsFields;
+    QString accessors;
+
+    content += "\n  // struct\n";
+    content += "  {\n";
+    content += QString("    _rtjs_%1_view_proto = jerry_create_object();\n").arg(structId);
+    cleanup.prepend(QString("  jerry_release_value(_rtjs_%1_view_proto);\n").arg(structId));
+    content += "    jerry_value_t offsets = jerry_create_object();\n\n";
+
+    for (int i = 0; i < st.mFields.count(); i++)
+    {
+      const Field &field(st.mFields.at(i));
+      const QString key(QString("_rtjs_%1_keys[%2]").arg(structId).arg(i));
+      const QString accessorName(QString("_rtjs_%1_%2").arg(structId, field.mName));
+      const QString member(QString("_rtjs_%1_this(this_val)->%2").arg(structId, field.mName));
+
+      toJsFields += "  {\n";
+      toJsFields += QString("    jerry_value_t field = %1;\n").arg(toJs(field.mParamType, field.mType, "value." + field.mName));
+      toJsFields += QString("    jerry_release_value(jerry_set_property(obj, %1, field));\n").arg(key);
+      toJsFields += "    jerry_release_value(field);\n";
+      toJsFields += "  }\n";
+
+      fromJsFields += "  {\n";
+      fromJsFields += QString("    jerry_value_t field = jerry_get_property(obj, %1);\n").arg(key);
+      fromJsFields += "    if (!jerry_value_is_undefined(field) && !jerry_value_is_error(field))\n";
+      fromJsFields += QString("      value.%1 = %2;\n").arg(field.mName, fromJs(field.mParamType, field.mType, "field"));
+      fromJsFields += "    jerry_release_value(field);\n";
+      fromJsFields += "  }\n";
+
+      accessors += readFile("getter.tpl").arg(accessorName).arg(toJs(field.mParamType, field.mType, member));
+      accessors += readFile("setter.tpl").arg(accessorName).arg(member).arg(fromJs(field.mParamType, field.mType, "args[0]"));
+
+      content += QString("    %1 = jerry_create_string((const jerry_char_t *)\"%2\");\n").arg(key, field.mName);
+      cleanup.prepend(QString("  jerry_release_value(%1);\n").arg(key));
+      content += QString("    _rtjs_define_accessor(_rtjs_%1_view_proto, %2, %3_get, %3_set);\n").arg(structId, key, accessorName);
+      content += QString("    _rtjs_set_number(offsets, \"%1\", offsetof(%2, %1));\n").arg(field.mName, structName);
+    }
 
-      for (const StaticFunction &m : qAsConst(c.mStaticFunctions))
-      {
-        const QString staticFunctionName(m.mName);
+    content += "\n";
+    content += "    jerry_value_t structObj = jerry_create_object();\n";
+    content += QString("    _rtjs_set_number(structObj, \"size\", sizeof(%1));\n").arg(structName);
+    content += "    jerry_value_t offsetsName = jerry_create_string((const jerry_char_t *)\"offsets\");\n";
+    content += "    jerry_release_value(jerry_set_property(structObj, offsetsName, offsets));\n";
+    // namespaces aren't objects in js, the global gets the identifier
+    content += QString("    jerry_value_t structObjName = jerry_create_string((const jerry_char_t *)\"%1\");\n").arg(structId);
+    content += "    jerry_release_value(jerry_set_property(glob_obj, structObjName, structObj));\n";
+    content += "    jerry_release_value(structObjName);\n";
+    content += "    jerry_release_value(structObj);\n";
+    content += "    jerry_release_value(offsetsName);\n";
+    content += "    jerry_release_value(offsets);\n";
+    content += "  }\n";
+
+    types += readFile("struct.tpl").arg(structName, QString::number(st.mFields.count()), toJsFields, fromJsFields, accessors, structId);
+  }
+
+  // > containers
+  if (!containerDefs.isEmpty())
+    types += readFile("containers.tpl");
+
+  for (const ContainerDef &container : qAsConst(containerDefs))
+  {
+    const bool isVector(container.mKind == ContainerDef::Kind::Vector);
 
-        classHandler += s("    {\n");
-        classHandler += s("      auto staticFunction = jerry_create_external_function(_rtjs_%1_%2_handler);\n").arg(className, staticFunctionName);
-        classHandler += s("      auto staticFunctionName = jerry_create_string((const jerry_char_t *)\"%1\");\n").arg(staticFunctionName);
-        classHandler += s("      auto prop = jerry_set_property(classObj, staticFunctionName, staticFunction);\n");
-        classHandler += s("    }\n");
+    if (container.mKind == ContainerDef::Kind::Map)
+    {
+      QString setKey;
+      QString getKey;
+      if (container.mKeyType == ParamType::Number)
+      {
+        setKey = "    _rtjs_set_number_key(obj, entry.first, element);";
+        getKey = QString("(%1)_rtjs_key_to_number(key)").arg(container.mKeyTypeString);
+      }
+      else
+      {
+        setKey += QString("    jerry_value_t key = %1;\n").arg(toJs(container.mKeyType, container.mKeyTypeString, "entry.first"));
+        setKey += "    jerry_release_value(jerry_set_property(obj, key, element));\n";
+        setKey += "    jerry_release_value(key);";
+        getKey = fromJs(container.mKeyType, container.mKeyTypeString, "key");
       }
 
-      classHandler += s("\n");
-      classHandler += s("    auto classObjName = jerry_create_string((const jerry_char_t *)\"%1\");\n").arg(className);
-      classHandler += s("    jerry_set_property(glob_obj, classObjName, classObj);\n");
-      classHandler += s("  }\n"); // end of class scope
-      content += classHandler;
+      types += readFile("container-map.tpl").arg(container.mCppType, container.mId)
+          .arg(toJs(container.mElementType, container.mElementTypeString, "entry.second"))
+          .arg(setKey).arg(getKey)
+          .arg(fromJs(container.mElementType, container.mElementTypeString, "element"));
+    }
+    else if (container.mElementType == ParamType::Number) // typed arrays
+    {
+      types += readFile("container-numbers.tpl").arg(container.mCppType, container.mId)
+          .arg(isVector ? "(_rtjs_length(value))" : "{}")
+          .arg(isVector ? "result.size()" : "std::min<size_t>(result.size(), _rtjs_length(value))");
+    }
+    else
+    {
+      types += readFile("container-array.tpl").arg(container.mCppType, container.mId)
+          .arg(toJs(container.mElementType, container.mElementTypeString, "value[i]"))
+          .arg(isVector ? "(length)" : "{}")
+          .arg(fromJs(container.mElementType, container.mElementTypeString, "element"));
     }
 
+    if (!container.mLazy)
+      continue;
 
-    //content += "\n}";
+    // element by element, maps give [key, value] entries like js maps do
+    QString element;
+    if (container.mKind == ContainerDef::Kind::Map)
+    {
+      element += "    jerry_value_t entry = jerry_create_array(2);\n";
+      element += QString("    jerry_value_t key = %1;\n").arg(toJs(container.mKeyType, container.mKeyTypeString, "element.first"));
+      element += QString("    jerry_value_t value = %1;\n").arg(toJs(container.mElementType, container.mElementTypeString, "element.second"));
+      element += "    jerry_release_value(jerry_set_property_by_index(entry, 0, key));\n";
+      element += "    jerry_release_value(jerry_set_property_by_index(entry, 1, value));\n";
+      element += "    jerry_release_value(key);\n";
+      element += "    jerry_release_value(value);\n";
+      element += "    return entry;";
+    }
+    else
+      element = QString("    return %1;").arg(toJs(container.mElementType, container.mElementTypeString, "element"));
 
+    types += readFile("container-lazy.tpl").arg(container.mCppType, container.mId, element);
+    content += QString("  _rtjs_%1_iterable::registerPrototypes();\n").arg(container.mId);
+    cleanup.prepend(QString("  _rtjs_%1_iterable::releasePrototypes();\n").arg(container.mId));
+  }
 
+  // > callbacks
+  for (const CallbackDef &callback : qAsConst(callbackDefs))
+  {
+    const bool isVoid(callback.mReturn.mType == ParamType::Void);
+    QStringList callParams({ "const jerry_value_t function" });
+    QStringList callArgs({ "function" });
+    QStringList trampolineParams;
+    QStringList jsArgs;
 
+    for (int i = 0; i < callback.mArgs.count(); i++)
+    {
+      const CallbackArg &arg(callback.mArgs.at(i));
+      trampolineParams += QString("%1 a%2").arg(arg.mCppType).arg(i);
 
+      if (arg.mType == ParamType::UserData)
+        continue;
 
-    // handlers
-    QString handlers;
+      callParams += QString("%1 a%2").arg(arg.mCppType).arg(i);
+      callArgs += QString("a%1").arg(i);
+      jsArgs += toJs(arg.mType, arg.mTypeString, QString("a%1").arg(i));
+    }
 
+    QString code;
+    code += QString("// callback %1\n").arg(callback.mSignature);
+    code += QString("static %1 _rtjs_%2_call(%3)\n").arg(callback.mReturn.mCppType, callback.mId, callParams.join(", "));
+    code += "{\n";
 
-    // > classes
-    for (const ClassDef &c : qAsConst(classDefs))
-    {
-      QString classHandler;
-      const QString &className(c.mName);
+    if (jsArgs.isEmpty())
+      code += "  jerry_value_t *args = nullptr;\n";
+    else // on the stack, nothing gets allocated per call
+      code += QString("  jerry_value_t args[%1] = { %2 };\n").arg(jsArgs.count()).arg(jsArgs.join(", "));
 
-      qWarning() << "handler for class" << className;
+    code += "  jerry_value_t undefined = jerry_create_undefined();\n";
+    code += QString("  jerry_value_t result = jerry_call_function(function, undefined, args, %1);\n").arg(jsArgs.count());
+    code += "  jerry_release_value(undefined);\n";
 
+    if (!jsArgs.isEmpty())
+    {
+      code += "  for (jerry_value_t arg : args)\n";
+      code += "    jerry_release_value(arg);\n";
+    }
 
-      // > statics
-      for (const StaticFunction &sf : qAsConst(c.mStaticFunctions))
-      {
-        qWarning() << "handler for" << className << sf.mName;
+    code += "\n";
+    code += "  if (jerry_value_is_error(result))\n";
+    code += "  {\n";
+    code += "    jerry_value_t error = jerry_get_value_from_error(result, true);\n";
+    code += "    rtjs::reportCallbackError(error); // native code only sees the default result\n";
+    code += "    jerry_release_value(error);\n";
+    code += isVoid ? "    return;\n" : QString("    return %1();\n").arg(callback.mReturn.mCppType);
+    code += "  }\n\n";
+
+    if (isVoid)
+      code += "  jerry_release_value(result);\n";
+    else
+    {
+      code += QString("  auto ret = %1;\n").arg(fromJs(callback.mReturn.mType, callback.mReturn.mTypeString, "result"));
+      code += "  jerry_release_value(result);\n";
+      code += "  return ret;\n";
+    }
 
-        s _classHandler = readFile("handler1.tpl").arg(QString("%1_%2").arg(className, sf.mName)).arg(sf.mParams.count());
-        //qWarning() << "?!?!?!?!" << _classHandler;
-        classHandler += _classHandler;
-        // TODO: !
-        classHandler += "  return jerry_create_undefined();\n";
-        classHandler += "}\n\n";
-      }
+    code += "}\n\n";
 
+    if (callback.mUserDataArg == -1) // std::function, which shares the reference to the js function between its copies
+    {
+      callArgs[0] = "ref->mFunction";
+
+      code += QString("static std::function<%1> _rtjs_%2_from_js(const jerry_value_t value)\n").arg(callback.mSignature, callback.mId);
+      code += "{\n";
+      code += "  if (!jerry_value_is_function(value))\n";
+      code += "    throw std::string(\"function expected\");\n\n";
+      code += "  std::shared_ptr<rtjs::FunctionRef> ref(std::make_shared<rtjs::FunctionRef>(value));\n";
+      code += QString("  return [ref](%1)\n").arg(trampolineParams.join(", "));
+      code += "  {\n";
+      code += "    rtjs::ExecutionBudget::checkCurrent(); // native loops calling back stop with an overrun evaluation\n";
+      code += QString("    return _rtjs_%1_call(%2);\n").arg(callback.mId, callArgs.join(", "));
+      code += "  };\n";
+      code += "}\n\n";
+    }
+    else // function pointer, the js function comes with the userdata
+    {
+      callArgs[0] = QString("static_cast<rtjs::FunctionRef *>(a%1)->mFunction").arg(callback.mUserDataArg);
+
+      code += QString("static %1 _rtjs_%2_trampoline(%3)\n").arg(callback.mReturn.mCppType, callback.mId, trampolineParams.join(", "));
+      code += "{\n";
+      code += "  // no exceptions through c frames: calls after an overrun return quietly, the handler reports it\n";
+      code += "  if (rtjs::ExecutionBudget::currentExceeded())\n";
+      code += isVoid ? "    return;\n" : QString("    return %1();\n").arg(callback.mReturn.mCppType);
+      code += "  try\n";
+      code += "  {\n";
+      code += QString("    return _rtjs_%1_call(%2);\n").arg(callback.mId, callArgs.join(", "));
+      code += "  }\n";
+      code += "  catch (const std::string &error) // a result not converting to the return type\n";
+      code += "  {\n";
+      code += "    jerry_value_t value = jerry_get_value_from_error(jerry_create_error(JERRY_ERROR_TYPE, (const jerry_char_t *)error.c_str()), true);\n";
+      code += "    rtjs::reportCallbackError(value);\n";
+      code += "    jerry_release_value(value);\n";
+      code += isVoid ? "    return;\n" : QString("    return %1();\n").arg(callback.mReturn.mCppType);
+      code += "  }\n";
+      code += "}\n\n";
+    }
 
-      // > members
-      for (const MemberFunction &m : qAsConst(c.mMemberFunctions))
-      {
-        classHandler += readFile("handler1.tpl").arg(QString("%1_%2").arg(className, m.mName)).arg(m.mParams.count());
-        // TODO: !
-        classHandler += "  return jerry_create_undefined();\n";
-        classHandler += "}\n\n";
-      }
+    types += code;
+  }
 
+  if (!table.isEmpty())
+  {
+    QString converters;
+    QStringList specialized;
+    for (const EnumDef &en : qAsConst(enumDefs))
+      converters += converterSpecialization(en.mName, en.mId, true);
+    for (const ClassDef &st : qAsConst(structDefs))
+      converters += converterSpecialization(st.mName, st.mId, true);
+    for (const ContainerDef &container : qAsConst(containerDefs))
+      converters += converterSpecialization(container.mCppType, container.mId, true, &specialized);
+    for (const CallbackDef &callback : qAsConst(callbackDefs))
+    {
+      if (callback.mUserDataArg == -1)
+        converters += converterSpecialization(QString("std::function<%1>").arg(callback.mSignature), callback.mId, false, &specialized);
+    }
 
-      // > class creator
-      if (!c.mMemberFunctions.isEmpty() || !c.mCtors.isEmpty()) // only for classes with other stuff than static functions
-      {
-        classHandler += s("jerry_value_t _rtjs_create_%1_object(%1 *class_ptr)\n").arg(className);
-        classHandler += s("{\n");
-        classHandler += s("  auto classObj = jerry_create_object();\n");
-        classHandler += s("  jerry_set_object_native_pointer(classObj, (void *)class_ptr, nullptr);\n");
+    types += "\n" + converters;
+    types += tableFunctions;
+    types += "static constexpr rtjs::Binding _rtjs_bindings[] =\n{\n" + table + "};\n\n";
+    content += "  rtjs::registerBindings(glob_obj, _rtjs_bindings);\n";
+  }
 
-        for (const MemberFunction &m : qAsConst(c.mMemberFunctions))
-        {
-          classHandler += readFile("function.tpl").arg(m.mName).arg(QString("%1_%2").arg(className, m.mName)).arg("classObj");
-        }
 
-        classHandler += s("\n");
-        classHandler += s("  return classObj;\n");
-        classHandler += s("}\n\n");
-      }
+#define s QString
 
+  // > classes
+  // all prototypes first, they get chained to each other below
+  for (const ClassDef &c : qAsConst(classDefs))
+  {
+    content += s("  _rtjs_%1_proto = jerry_create_object();\n").arg(c.mId);
+    cleanup.prepend(s("  jerry_release_value(_rtjs_%1_proto);\n").arg(c.mId));
+  }
 
-      // > ctors
-      // TODO: don't create ctor if ctor deleted or private
-      if (c.mCtors.isEmpty()) // create default ctor
-      {
-        classHandler += readFile("handler1.tpl").arg(QString("%1_ctor%2").arg(className).arg(0)).arg(0);
+  for (const ClassDef &c : qAsConst(classDefs))
+  {
+//      if (c.mStaticFunctions.isEmpty()) // no need for global definitions for nen-static members
+//        continue;
 
-        //classHandler += s("jerry_value_t _rtjs_%1_ctor0_handler()\n").arg(className);
-        //classHandler += s("{\n");
-        classHandler += s("  auto *class_ptr = new %1;\n").arg(className);
-        classHandler += s("  auto classObj = _rtjs_create_%1_object(class_ptr);\n").arg(className);
-        classHandler += s("  jerry_set_object_native_pointer(classObj, (void *)class_ptr, nullptr);\n");
+    QString classHandler;
+    const QString &className(c.mName);
+    const QString &classId(c.mId);
 
-        for (const MemberFunction &m : qAsConst(c.mMemberFunctions))
-        {
-          classHandler += readFile("function.tpl").arg(m.mName).arg(QString("%1_%2").arg(className, m.mName)).arg("classObj");
-        }
+    qWarning() << "handler for class" << className;
 
-        classHandler += s("\n");
-        classHandler += s("  return classObj;\n");
-        classHandler += s("}\n\n");
-      }
+    classHandler += "\n";
+    classHandler += "  // class\n";
+    classHandler += "  {\n"; // scoped class
+    classHandler += "    auto classObj = jerry_create_object();\n\n";
 
+    // public fields, read and written in place through the prototype
+    for (const Field &field : c.mFields)
+    {
+      if (!isValueType(field.mParamType))
+        continue;
+
+      classHandler += s("    {\n");
+      classHandler += s("      auto fieldName = jerry_create_string((const jerry_char_t *)\"%1\");\n").arg(field.mName);
+      classHandler += s("      _rtjs_define_accessor(_rtjs_%1_proto, fieldName, _rtjs_%1_%2_get, %3);\n")
+          .arg(classId, field.mName, field.mConst ? s("nullptr") : s("_rtjs_%1_%2_set").arg(classId, field.mName));
+      classHandler += s("      jerry_release_value(fieldName);\n");
+      classHandler += s("    }\n");
+    }
 
-      // TODO: for (int ctorn = 0; ctorn < c.mCtors.count(); ctorn++)//const Ctor &ctor : qAsConst(c.mCtors))
+    // member functions, once per class: objects of derived classes reach them through the prototype chain
+    for (const MemberFunction &m : qAsConst(c.mMemberFunctions))
+    {
+      classHandler += s("    {\n");
+      classHandler += s("      auto memberFunction = jerry_create_external_function(_rtjs_%1_%2_handler);\n").arg(classId, m.mName);
+      classHandler += s("      auto memberFunctionName = jerry_create_string((const jerry_char_t *)\"%1\");\n").arg(m.mName);
+      classHandler += s("      jerry_release_value(jerry_set_property(_rtjs_%1_proto, memberFunctionName, memberFunction));\n").arg(classId);
+      classHandler += s("      jerry_release_value(memberFunctionName);\n");
+      classHandler += s("      jerry_release_value(memberFunction);\n");
+      classHandler += s("    }\n");
+    }
+    classHandler += "\n";
 
+    //int ctorn = 0;
+    // TODO: don't create ctor if ctor deleted or private
+    for (int ctorn = 0; (ctorn < c.mCtors.count() || ctorn == 0) /* at least one ctor! */; ctorn++)//const Ctor &ctor : qAsConst(c.mCtors))
+    {
+      classHandler += s("    {\n");
+      classHandler += s("      auto ctor = jerry_create_external_function(_rtjs_%1_ctor%2_handler);\n").arg(classId).arg(ctorn);
+      classHandler += s("      auto ctorName = jerry_create_string((const jerry_char_t *)\"ctor%1\");\n").arg(ctorn);
+      classHandler += s("      jerry_release_value(jerry_set_property(classObj, ctorName, ctor));\n");
+      classHandler += s("      jerry_release_value(ctorName);\n");
+      classHandler += s("      jerry_release_value(ctor);\n");
+      classHandler += s("    }\n");
+
+      //ctorn++;
+    }
 
-      handlers += classHandler;
+    for (const StaticFunction &m : qAsConst(c.mStaticFunctions))
+    {
+      const QString staticFunctionName(m.mName);
+
+      classHandler += s("    {\n");
+      classHandler += s("      auto staticFunction = jerry_create_external_function(_rtjs_%1_%2_handler);\n").arg(classId, staticFunctionName);
+      classHandler += s("      auto staticFunctionName = jerry_create_string((const jerry_char_t *)\"%1\");\n").arg(staticFunctionName);
+      classHandler += s("      jerry_release_value(jerry_set_property(classObj, staticFunctionName, staticFunction));\n");
+      classHandler += s("      jerry_release_value(staticFunctionName);\n");
+      classHandler += s("      jerry_release_value(staticFunction);\n");
+      classHandler += s("    }\n");
     }
 
+    classHandler += s("\n");
+    classHandler += s("    auto classObjName = jerry_create_string((const jerry_char_t *)\"%1\");\n").arg(classId); // like structs
+    classHandler += s("    jerry_release_value(jerry_set_property(glob_obj, classObjName, classObj));\n");
+    classHandler += s("    jerry_release_value(classObjName);\n");
+    classHandler += s("    jerry_release_value(classObj);\n");
+    classHandler += s("  }\n"); // end of class scope
+    content += classHandler;
+  }
 
-    // > functions
-    for(const Function &f : qAsConst(functions))
+  // > inheritance
+  // the first base is the prototype of the prototype, further ones are mixed in (js has a single chain).
+  // bases before the classes derived from them, so that what gets mixed in is complete
+  QVector<const ClassDef *> byDepth;
+  for (const ClassDef &c : qAsConst(classDefs))
+    byDepth += &c;
+  std::stable_sort(byDepth.begin(), byDepth.end(), [](const ClassDef *a, const ClassDef *b)
+  {
+    return inheritanceDepth(a->mName) < inheritanceDepth(b->mName);
+  });
+
+  for (const ClassDef *c : qAsConst(byDepth))
+  {
+    const QStringList bases(exposedBases(*c));
+    for (int i = 0; i < bases.count(); i++)
     {
-      const QString &fnName(f.mName);
-      qWarning() << "handler for function" << f.mName;
+      if (i == 0)
+        content += s("  jerry_release_value(jerry_set_prototype(_rtjs_%1_proto, _rtjs_%2_proto));\n").arg(c->mId, classDefs.value(bases.at(i)).mId);
+      else
+        content += s("  rtjs::mixinPrototype(_rtjs_%1_proto, _rtjs_%2_proto);\n").arg(c->mId, classDefs.value(bases.at(i)).mId);
+    }
+  }
 
-      handlers += readFile("handler1.tpl").arg(f.mName).arg(f.mParams.count());
 
+  //content += "\n}";
 
-      // get parameters
-      QStringList pns;
-      int pn = 0;
-      for (const Parameter &p : qAsConst(f.mParams))
-      {
-        QString getter;
 
-        if (p.paramType == ParamType::Boolean)
-          getter = QString("  auto _param%1 = jerry_value_to_boolean(args[%1]);\n").arg(pn);
-        else if (p.paramType == ParamType::Pointer)
-        {
-          getter += QString("  auto jsParam%1 = args[%1];\n").arg(pn);
-          getter += QString("  void *param%1Ptr = nullptr;\n").arg(pn);
-          getter += QString("  if (!jerry_get_object_native_pointer(jsParam%1, &param%1Ptr, nullptr))\n").arg(pn);
-          getter += QString("    throw std::string(\"some handler called with no raw pointer behind it!\");\n");
-          getter += QString("  auto *_param%1 = static_cast<%2>(param%1Ptr);\n").arg(pn).arg(p.mType);
-        }
-        else
-          getter = "oopsgetter";
 
-        handlers += getter;
 
-        handlers += QString("  auto param%1 = _param%1;\n").arg(pn);
 
-        pns += QString("param%1").arg(pn);
-        pn++;
-      }
+  // handlers
+  QString classHandlers;
 
 
-      // call c/c++ function
-      handlers += QString("  auto ret = %1(%2);\n").arg(fnName).arg(pns.join(", "));
-      handlers += QString("  std::cerr << \"ret = \" << ret << std::endl;\n");
+  // > class infos
+  // all of them first, the upcast table of a class refers to the infos of the classes derived from it
+  for (const ClassDef &c : qAsConst(classDefs))
+  {
+    classHandlers += s("static void _rtjs_%1_free(void *ptr);\n").arg(c.mId);
+    classHandlers += s("static const jerry_object_native_info_t _rtjs_%1_info = { _rtjs_%1_free };\n").arg(c.mId);
+  }
+  classHandlers += "\n";
 
-      switch (f.mReturnType)
-      {
-        case ParamType::Boolean:
-        {
-          handlers += QString("  return jerry_create_boolean(ret);\n");
-          break;
-        }
+  for (const ClassDef &c : qAsConst(classDefs))
+  {
+    for (const QString &base : c.mBases)
+    {
+      if (!classDefs.contains(base))
+        qWarning() << "(" << c.mName << "doesn't inherit from" << base << "in js, that one isn't wrapped)";
+    }
 
-        case ParamType::Pointer:
-        {
-          // return new object with pointer in it
+    // the class itself and every class derived from it, with the offset of its subobject
+    QString upcasts(s("  { &_rtjs_%1_info, 0 },\n").arg(c.mId));
+    for (const ClassDef &derived : qAsConst(classDefs))
+    {
+      const int count = ancestorCount(derived.mName, c.mName);
+      if (count == 1)
+        upcasts += s("  { &_rtjs_%1_info, rtjs::upcastOffset<%2, %3>() },\n").arg(derived.mId, derived.mName, c.mName);
+      else if (count > 1)
+        qWarning() << "(" << derived.mName << "objects can't be passed as" << c.mName << ", it is an ambiguous base of them)";
+    }
+    classHandlers += s("static const rtjs::Upcast _rtjs_%1_upcasts[] =\n{\n%2};\n\n").arg(c.mId, upcasts);
+  }
 
-          handlers += "  jerry_value_t retObj = jerry_create_object();\n";
-          handlers += "  jerry_set_object_native_pointer(retObj, (void *)ret, nullptr);\n";
-          handlers += "  return retObj;\n";
-          break;
-        }
 
-        default:
-        {
-          handlers += "  oopshandler\n";
-          break;
-        }
+  // > classes
+  // lookups and accessors of all classes before any handler, handlers may take objects of any class
+  for (const ClassDef &c : qAsConst(classDefs))
+  {
+    const QString &className(c.mName);
+    const QString &classId(c.mId);
+
+    // > fields
+    QString accessors;
+    for (const Field &field : c.mFields)
+    {
+      if (!isValueType(field.mParamType))
+      {
+        qWarning() << "(not exposing field" << field.mName << "of type" << field.mType << ")";
+        continue;
       }
 
+      const QString accessorName(QString("_rtjs_%1_%2").arg(classId, field.mName));
+      const QString member(QString("_rtjs_%1_this(this_val)->%2").arg(classId, field.mName));
 
-      handlers += "\n}\n\n";
+      accessors += readFile("getter.tpl").arg(accessorName).arg(toJs(field.mParamType, field.mType, member));
+      if (!field.mConst)
+        accessors += readFile("setter.tpl").arg(accessorName).arg(member).arg(fromJs(field.mParamType, field.mType, "args[0]"));
+    }
+    classHandlers += readFile("class-proto.tpl").arg(className, accessors, hasVirtualDestructor(className) ? "true" : "false", classId);
+  }
+
+  for (const ClassDef &c : qAsConst(classDefs))
+  {
+    QString classHandler;
+    const QString &className(c.mName);
+    const QString &classId(c.mId);
+
+    qWarning() << "handler for class" << className;
+
+
+    // > statics
+    for (const StaticFunction &sf : qAsConst(c.mStaticFunctions))
+    {
+      qWarning() << "handler for" << className << sf.mName;
+
+      const Validation level = sf.mValidation == Validation::Default ? validation : sf.mValidation;
+      classHandler += readFile("handler1.tpl").arg(QString("%1_%2").arg(classId, sf.mName)).arg(argcCheck(sf, level));
+      classHandler += handlerBody(sf, s("%1::%2").arg(className, sf.mName), level);
+      classHandler += "}\n\n";
     }
 
 
-    QString init(readFile("init-head.tpl"));
+    // > members
+    for (const MemberFunction &m : qAsConst(c.mMemberFunctions))
+    {
+      const Validation level = m.mValidation == Validation::Default ? validation : m.mValidation;
+      classHandler += readFile("handler1.tpl").arg(QString("%1_%2").arg(classId, m.mName)).arg(argcCheck(m, level));
+      classHandler += handlerBody(m, s("_rtjs_%1_this(this_val)->%2").arg(classId, m.mName), level);
+      classHandler += "}\n\n";
+    }
 
 
-    for (const QString &include : qAsConst(includes))
-      init += QString("#include \"%1\"\n").arg(include);
-    for (const QString &include : qAsConst(sourceFiles))
-      init += QString("#include \"%1\"\n").arg(include);
+    // > ctors
+    // TODO: don't create ctor if ctor deleted or private
+    if (c.mCtors.isEmpty()) // create default ctor
+    {
+      classHandler += readFile("handler1.tpl").arg(QString("%1_ctor%2").arg(classId).arg(0)).arg(argcCheck(className, 0, validation));
+      classHandler += s("  return _rtjs_adopt_%1_object(std::unique_ptr<%2>(new %2)); // deleted with its wrapper\n").arg(classId, className);
+      classHandler += s("}\n\n");
+    }
 
 
-    init += "\n\n";
+    // TODO: for (int ctorn = 0; ctorn < c.mCtors.count(); ctorn++)//const Ctor &ctor : qAsConst(c.mCtors))
 
-    init += handlers;
-    init += readFile("init.tpl").arg("TestTarget").arg(content);
 
+    classHandlers += classHandler;
+  }
 
-    QFile out(output);
 
-    assert(out.open(QIODevice::WriteOnly));
+  QString init(readFile("init-head.tpl"));
 
-    out.write(init.toUtf8());
-    out.flush();
+  if (async)
+    init += "#include <rtjs/workerpool.h>\n";
 
-    //qWarning() << "init" << init;
+  if (!containerDefs.isEmpty())
+  {
+    init += "#include <algorithm>\n#include <array>\n#include <map>\n#include <unordered_map>\n#include <vector>\n";
+    init += "#include <rtjs/iterable.h>\n";
   }
 
+  if (!table.isEmpty())
+    init += "#include <rtjs/bindings.h>\n";
+
+  for (const QString &include : qAsConst(sourceFiles))
+    init += QString("#include \"%1\"\n").arg(include);
+
+  // after every header: the counting macros only apply to the generated code, inline functions of the
+  // headers must be the same in every translation unit of the program
+  if (audit)
+    init += "\n#include <rtjs/audit.h>\n";
+
+  init += "\n\n";
+  init += readFile("init-helpers.tpl");
+
+  init += types;
+  init += classHandlers;
+
+  QString tail(readFile("init.tpl").arg("TestTarget", content, cleanup));
+  if (audit)
+    tail += "\n#include <rtjs/auditend.h>\n";
+
+  if (!writeOutput(output, init.toUtf8(), handlers, tail.toUtf8()))
+    return -1;
+
 
   qWarning() << "rtjs done";
   return 0;
 }
+
+
+// thin client, run before anything expensive: hands the working directory and the command line to
+// rtjsgen --daemon listening on the --server socket. false if there is none, to generate in-process then
+bool runClient(int argc, char **argv, int &exitCode)
+{
+  const char *socketPath = nullptr;
+  char cwd[PATH_MAX];
+  if (!getcwd(cwd, sizeof(cwd)))
+    return false;
+
+  // NUL separated, an empty string terminates
+  std::string request(cwd, strlen(cwd) + 1);
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--server") == 0 && i + 1 < argc)
+    {
+      socketPath = argv[++i];
+      continue;
+    }
+    request.append(argv[i], strlen(argv[i]) + 1);
+  }
+  request += '\0';
+
+  if (!socketPath)
+    return false;
+
+  const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, socketPath, sizeof(address.sun_path) - 1);
+
+  if (fd < 0 || ::connect(fd, (const sockaddr *)&address, sizeof(address)) != 0)
+  {
+    if (fd >= 0)
+      close(fd);
+    return false;
+  }
+
+  bool sent = true;
+  for (size_t done = 0; sent && done < request.size();)
+  {
+    const ssize_t count = write(fd, request.data() + done, request.size() - done);
+    sent = count > 0;
+    done += sent ? (size_t)count : 0;
+  }
+
+  // the exit code, once generation is done
+  std::string reply;
+  char buffer[64];
+  ssize_t count;
+  while (sent && (count = read(fd, buffer, sizeof(buffer))) > 0)
+    reply.append(buffer, (size_t)count);
+  close(fd);
+
+  if (reply.empty()) // the daemon went away
+    return false;
+
+  exitCode = atoi(reply.c_str());
+  return true;
+}
+
+
+// keeps the parsed headers of every output it generated, watches them (inotify) and regenerates
+// the outputs depending on a header as soon as it changes. requests of up to date outputs return at once
+int runDaemon(const QString &socketPath)
+{
+  class Job
+  {
+  public:
+    QString mDirectory;
+    QStringList mArgs;
+    ParseCache mCache;
+    int mExitCode = 0;
+    bool mUpToDate = false;
+  };
+
+  std::map<QString, std::unique_ptr<Job>> jobs; // by output
+  QFileSystemWatcher watcher;
+
+  auto run = [&watcher](Job &job)
+  {
+    QElapsedTimer timer;
+    timer.start();
+
+    QDir::setCurrent(job.mDirectory);
+    job.mExitCode = generate(job.mArgs, &job.mCache);
+    job.mUpToDate = job.mExitCode == 0; // failures are retried on the next request
+
+    const QStringList dependencies(job.mCache.dependencies());
+    if (!dependencies.isEmpty())
+      watcher.addPaths(dependencies);
+
+    qWarning() << "generated in" << timer.elapsed() << "ms, exit code" << job.mExitCode;
+  };
+
+  QObject::connect(&watcher, &QFileSystemWatcher::fileChanged, [&](const QString &path)
+  {
+    for (auto &job : jobs)
+    {
+      if (job.second->mCache.invalidate(path))
+        run(*job.second);
+    }
+
+    // editors saving by rename drop the watch
+    if (QFileInfo::exists(path) && !watcher.files().contains(path))
+      watcher.addPath(path);
+  });
+
+  QLocalServer::removeServer(socketPath);
+  QLocalServer server;
+  if (!server.listen(socketPath))
+  {
+    qWarning() << "cannot listen on" << socketPath << server.errorString();
+    return -1;
+  }
+
+  QObject::connect(&server, &QLocalServer::newConnection, [&]()
+  {
+    QLocalSocket *socket = server.nextPendingConnection();
+    QObject::connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+    QObject::connect(socket, &QLocalSocket::readyRead, [&, socket]()
+    {
+      QByteArray request(socket->property("request").toByteArray() + socket->readAll());
+      if (!request.endsWith(QByteArray("\0\0", 2)))
+      {
+        socket->setProperty("request", request);
+        return;
+      }
+
+      request.chop(2);
+      QList<QByteArray> parts(request.split('\0'));
+      const QString directory(QString::fromUtf8(parts.takeFirst()));
+
+      QStringList args({ "rtjsgen" });
+      for (const QByteArray &part : qAsConst(parts))
+        args += QString::fromUtf8(part);
+
+      const int outputArg = args.indexOf("-O");
+      const QString output(outputArg >= 0 && outputArg + 1 < args.count()
+                           ? QDir(directory).absoluteFilePath(args.at(outputArg + 1)) : QString());
+
+      std::unique_ptr<Job> &job(jobs[output]);
+      if (!job || job->mArgs != args || job->mDirectory != directory)
+      {
+        job.reset(new Job);
+        job->mDirectory = directory;
+        job->mArgs = args;
+      }
+
+      if (!job->mUpToDate || !QFileInfo::exists(output))
+        run(*job);
+      else
+        qWarning() << "(" << output << "up to date )";
+
+      socket->write(QByteArray::number(job->mExitCode) + "\n");
+      socket->disconnectFromServer();
+    });
+  });
+
+  qWarning() << "rtjsgen daemon listening on" << socketPath;
+  return QCoreApplication::exec();
+}
+
+
+int main(int argc, char **argv)
+{
+  int exitCode;
+  if (runClient(argc, argv, exitCode))
+    return exitCode;
+
+  Q_INIT_RESOURCE(res);
+  QCoreApplication app(argc, argv);
+
+  QStringList args(app.arguments());
+
+  const int daemonArg = args.indexOf("--daemon");
+  if (daemonArg >= 0)
+  {
+    if (daemonArg + 1 >= args.count())
+    {
+      qWarning() << "usage:" << args.at(0) << "--daemon <socket path>";
+      return -1;
+    }
+    return runDaemon(args.at(daemonArg + 1));
+  }
+
+  // no daemon running, generate in-process
+  const int serverArg = args.indexOf("--server");
+  if (serverArg >= 0)
+    args.erase(args.begin() + serverArg, args.begin() + qMin(serverArg + 2, args.count()));
+
+  return generate(args, nullptr);
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+// reference accounting for generated bindings, included by code generated with rtjsgen --audit
+// (RtjsTarget AUDIT): every engine value created or released through the jerry_* calls below is counted,
+// and every binding call checks that it gave back all it took. leaks are reported per binding at exit.
+// the macros apply from here to rtjs/auditend.h: after all other headers, so that their inline functions
+// stay the same in every translation unit. values the runtime headers hand over are counted explicitly
+// with RTJS_AUDIT_CREATED()
+
+#include <jerryscript.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <map>
+#include <string>
+
+
+namespace rtjs
+{
+namespace audit
+{
+
+
+class Stats
+{
+public:
+  unsigned long long mCalls = 0;
+  long long mLeaked = 0; // values left behind by all calls together (negative: released too often)
+};
+
+
+// values created and not released yet, by the code compiled with this header
+inline long long &live()
+{
+  static long long count = 0;
+  return count;
+}
+
+
+inline bool report();
+
+
+inline std::map<std::string, Stats> &stats()
+{
+  static std::map<std::string, Stats> *bindings = nullptr;
+  if (!bindings)
+  {
+    bindings = new std::map<std::string, Stats>; // still there for atexit
+    atexit([]() { report(); });
+  }
+  return *bindings;
+}
+
+
+// returns false if any binding leaked
+inline bool report()
+{
+  bool clean = true;
+  for (const auto &binding : stats())
+  {
+    if (binding.second.mLeaked == 0)
+      continue;
+
+    fprintf(stderr, "rtjs audit: %s leaked %lld values in %llu calls\n",
+            binding.first.c_str(), binding.second.mLeaked, binding.second.mCalls);
+    clean = false;
+  }
+
+  if (clean)
+    fprintf(stderr, "rtjs audit: no leaks in %zu bindings\n", stats().size());
+  return clean;
+}
+
+
+// one binding call. returned: values the call hands over to the engine (1 for handlers, 0 otherwise)
+class Scope
+{
+public:
+  Scope(const char *name, int returned)
+    : mName(name)
+    , mReturned(returned)
+    , mStart(live())
+  {
+  }
+
+  ~Scope()
+  {
+    const int returned = std::uncaught_exception() ? 0 : mReturned;
+    Stats &binding(stats()[mName]);
+    binding.mCalls++;
+    binding.mLeaked += live() - mStart - returned;
+    live() -= returned; // owned by the engine from now on, it releases it without us knowing
+  }
+
+  Scope(const Scope &) = delete;
+  Scope &operator=(const Scope &) = delete;
+
+private:
+  const char *mName;
+  const int mReturned;
+  const long long mStart;
+};
+
+
+inline jerry_value_t created(const jerry_value_t value)
+{
+  live()++;
+  return value;
+}
+
+
+inline void released(const jerry_value_t value)
+{
+  live()--;
+  jerry_release_value(value);
+}
+
+
+inline jerry_value_t valueFromError(const jerry_value_t value, bool release)
+{
+  if (release)
+    live()--;
+  return created(jerry_get_value_from_error(value, release));
+}
+
+
+inline void freeDescriptor(const jerry_property_descriptor_t *desc)
+{
+  live() -= desc->is_value_defined + desc->is_get_defined + desc->is_set_defined;
+  jerry_free_property_descriptor_fields(desc);
+}
+
+
+}
+}
+
+
+#define RTJS_AUDIT_SCOPE(name) rtjs::audit::Scope _rtjs_audit_scope(name, 1)
+#define RTJS_AUDIT_TASK(name) rtjs::audit::Scope _rtjs_audit_scope(name, 0)
+#define RTJS_AUDIT_CREATED(value) rtjs::audit::created(value)
+
+// everything returning a value the caller has to release
+#define jerry_acquire_value(...) rtjs::audit::created(jerry_acquire_value(__VA_ARGS__))
+#define jerry_call_function(...) rtjs::audit::created(jerry_call_function(__VA_ARGS__))
+#define jerry_construct_object(...) rtjs::audit::created(jerry_construct_object(__VA_ARGS__))
+#define jerry_create_array(...) rtjs::audit::created(jerry_create_array(__VA_ARGS__))
+#define jerry_create_arraybuffer(...) rtjs::audit::created(jerry_create_arraybuffer(__VA_ARGS__))
+#define jerry_create_arraybuffer_external(...) rtjs::audit::created(jerry_create_arraybuffer_external(__VA_ARGS__))
+#define jerry_create_boolean(...) rtjs::audit::created(jerry_create_boolean(__VA_ARGS__))
+#define jerry_create_error(...) rtjs::audit::created(jerry_create_error(__VA_ARGS__))
+#define jerry_create_error_sz(...) rtjs::audit::created(jerry_create_error_sz(__VA_ARGS__))
+#define jerry_create_external_string(...) rtjs::audit::created(jerry_create_external_string(__VA_ARGS__))
+#define jerry_create_external_string_sz(...) rtjs::audit::created(jerry_create_external_string_sz(__VA_ARGS__))
+#define jerry_create_external_function(...) rtjs::audit::created(jerry_create_external_function(__VA_ARGS__))
+#define jerry_create_null(...) rtjs::audit::created(jerry_create_null(__VA_ARGS__))
+#define jerry_create_number(...) rtjs::audit::created(jerry_create_number(__VA_ARGS__))
+#define jerry_create_object(...) rtjs::audit::created(jerry_create_object(__VA_ARGS__))
+#define jerry_create_promise(...) rtjs::audit::created(jerry_create_promise(__VA_ARGS__))
+#define jerry_create_string(...) rtjs::audit::created(jerry_create_string(__VA_ARGS__))
+#define jerry_create_string_from_utf8(...) rtjs::audit::created(jerry_create_string_from_utf8(__VA_ARGS__))
+#define jerry_create_string_sz(...) rtjs::audit::created(jerry_create_string_sz(__VA_ARGS__))
+#define jerry_create_string_sz_from_utf8(...) rtjs::audit::created(jerry_create_string_sz_from_utf8(__VA_ARGS__))
+#define jerry_create_typedarray(...) rtjs::audit::created(jerry_create_typedarray(__VA_ARGS__))
+#define jerry_create_typedarray_for_arraybuffer(...) rtjs::audit::created(jerry_create_typedarray_for_arraybuffer(__VA_ARGS__))
+#define jerry_create_typedarray_for_arraybuffer_sz(...) rtjs::audit::created(jerry_create_typedarray_for_arraybuffer_sz(__VA_ARGS__))
+#define jerry_create_undefined(...) rtjs::audit::created(jerry_create_undefined(__VA_ARGS__))
+#define jerry_define_own_property(...) rtjs::audit::created(jerry_define_own_property(__VA_ARGS__))
+#define jerry_eval(...) rtjs::audit::created(jerry_eval(__VA_ARGS__))
+#define jerry_exec_snapshot(...) rtjs::audit::created(jerry_exec_snapshot(__VA_ARGS__))
+#define jerry_get_global_object(...) rtjs::audit::created(jerry_get_global_object(__VA_ARGS__))
+#define jerry_get_object_keys(...) rtjs::audit::created(jerry_get_object_keys(__VA_ARGS__))
+#define jerry_get_property(...) rtjs::audit::created(jerry_get_property(__VA_ARGS__))
+#define jerry_get_property_by_index(...) rtjs::audit::created(jerry_get_property_by_index(__VA_ARGS__))
+#define jerry_get_prototype(...) rtjs::audit::created(jerry_get_prototype(__VA_ARGS__))
+#define jerry_get_typedarray_buffer(...) rtjs::audit::created(jerry_get_typedarray_buffer(__VA_ARGS__))
+#define jerry_has_property(...) rtjs::audit::created(jerry_has_property(__VA_ARGS__))
+#define jerry_parse(...) rtjs::audit::created(jerry_parse(__VA_ARGS__))
+#define jerry_resolve_or_reject_promise(...) rtjs::audit::created(jerry_resolve_or_reject_promise(__VA_ARGS__))
+#define jerry_run(...) rtjs::audit::created(jerry_run(__VA_ARGS__))
+#define jerry_run_all_enqueued_jobs(...) rtjs::audit::created(jerry_run_all_enqueued_jobs(__VA_ARGS__))
+#define jerry_set_property(...) rtjs::audit::created(jerry_set_property(__VA_ARGS__))
+#define jerry_set_property_by_index(...) rtjs::audit::created(jerry_set_property_by_index(__VA_ARGS__))
+#define jerry_set_prototype(...) rtjs::audit::created(jerry_set_prototype(__VA_ARGS__))
+#define jerry_value_to_number(...) rtjs::audit::created(jerry_value_to_number(__VA_ARGS__))
+#define jerry_value_to_object(...) rtjs::audit::created(jerry_value_to_object(__VA_ARGS__))
+#define jerry_value_to_string(...) rtjs::audit::created(jerry_value_to_string(__VA_ARGS__))
+
+#define jerry_release_value(...) rtjs::audit::released(__VA_ARGS__)
+#define jerry_get_value_from_error(...) rtjs::audit::valueFromError(__VA_ARGS__)
+#define jerry_free_property_descriptor_fields(...) rtjs::audit::freeDescriptor(__VA_ARGS__)
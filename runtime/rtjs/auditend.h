@@ -0,0 +1,52 @@
+// ends the counting macros of rtjs/audit.h, last in code generated with rtjsgen --audit
+
+#undef RTJS_AUDIT_SCOPE
+#undef RTJS_AUDIT_TASK
+#undef RTJS_AUDIT_CREATED
+#undef jerry_acquire_value
+#undef jerry_call_function
+#undef jerry_construct_object
+#undef jerry_create_array
+#undef jerry_create_arraybuffer
+#undef jerry_create_arraybuffer_external
+#undef jerry_create_boolean
+#undef jerry_create_error
+#undef jerry_create_error_sz
+#undef jerry_create_external_string
+#undef jerry_create_external_string_sz
+#undef jerry_create_external_function
+#undef jerry_create_null
+#undef jerry_create_number
+#undef jerry_create_object
+#undef jerry_create_promise
+#undef jerry_create_string
+#undef jerry_create_string_from_utf8
+#undef jerry_create_string_sz
+#undef jerry_create_string_sz_from_utf8
+#undef jerry_create_typedarray
+#undef jerry_create_typedarray_for_arraybuffer
+#undef jerry_create_typedarray_for_arraybuffer_sz
+#undef jerry_create_undefined
+#undef jerry_define_own_property
+#undef jerry_eval
+#undef jerry_exec_snapshot
+#undef jerry_get_global_object
+#undef jerry_get_object_keys
+#undef jerry_get_property
+#undef jerry_get_property_by_index
+#undef jerry_get_prototype
+#undef jerry_get_typedarray_buffer
+#undef jerry_has_property
+#undef jerry_parse
+#undef jerry_resolve_or_reject_promise
+#undef jerry_run
+#undef jerry_run_all_enqueued_jobs
+#undef jerry_set_property
+#undef jerry_set_property_by_index
+#undef jerry_set_prototype
+#undef jerry_value_to_number
+#undef jerry_value_to_object
+#undef jerry_value_to_string
+#undef jerry_release_value
+#undef jerry_get_value_from_error
+#undef jerry_free_property_descriptor_fields
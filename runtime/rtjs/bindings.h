@@ -0,0 +1,188 @@
+#pragma once
+
+#include <jerryscript.h>
+
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+
+namespace rtjs
+{
+
+
+// js <-> c++ conversion per (decayed) type, rtjsgen specializes it for the enums, structs,
+// containers and callbacks it generates converters for
+template<typename T, typename Enable = void>
+struct Converter;
+
+
+template<>
+struct Converter<bool>
+{
+  static bool fromJs(const jerry_value_t value)
+  {
+    return jerry_value_to_boolean(value);
+  }
+
+  static jerry_value_t toJs(const bool value)
+  {
+    return jerry_create_boolean(value);
+  }
+};
+
+
+template<typename T>
+struct Converter<T, typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>::type>
+{
+  static T fromJs(const jerry_value_t value)
+  {
+    // NaN, the infinities and out of range numbers don't cast to integer types
+    const double number = jerry_get_number_value(value);
+    if (std::is_integral<T>::value
+        && !(number >= (double)std::numeric_limits<T>::lowest() && number < (double)std::numeric_limits<T>::max() + 1.0))
+      throw std::string("number out of range");
+
+    return (T)number;
+  }
+
+  static jerry_value_t toJs(const T value)
+  {
+    return jerry_create_number((double)value);
+  }
+};
+
+
+template<>
+struct Converter<std::string>
+{
+  static std::string fromJs(const jerry_value_t value)
+  {
+    if (!jerry_value_is_string(value))
+      throw std::string("string expected");
+
+    std::string result(jerry_get_utf8_string_size(value), '\0');
+    jerry_string_to_utf8_char_buffer(value, (jerry_char_t *)&result[0], (jerry_size_t)result.size());
+    return result;
+  }
+
+  static jerry_value_t toJs(const std::string &value)
+  {
+    return jerry_create_string_sz_from_utf8((const jerry_char_t *)value.data(), (jerry_size_t)value.size());
+  }
+};
+
+
+// one entry of the constexpr table rtjsgen emits with --table
+struct Binding
+{
+  const char *mName;
+  jerry_external_handler_t mHandler; // Signature<F>::handler, shared by all functions of the same type
+  const void *mFunction; // points to the F * to call
+};
+
+
+namespace detail
+{
+
+
+template<std::size_t ...I>
+struct Indices
+{
+};
+
+
+template<std::size_t N, std::size_t ...I>
+struct MakeIndices : MakeIndices<N - 1, N - 1, I...>
+{
+};
+
+
+template<std::size_t ...I>
+struct MakeIndices<0, I...>
+{
+  typedef Indices<I...> type;
+};
+
+
+inline const jerry_object_native_info_t *bindingInfo()
+{
+  static const jerry_object_native_info_t info = { nullptr }; // the table is static
+  return &info;
+}
+
+
+template<typename R>
+struct Call
+{
+  template<typename ...A, std::size_t ...I>
+  static jerry_value_t call(R (*function)(A...), const jerry_value_t args[], Indices<I...>)
+  {
+    return Converter<typename std::decay<R>::type>::toJs(function(Converter<typename std::decay<A>::type>::fromJs(args[I])...));
+  }
+};
+
+
+template<>
+struct Call<void>
+{
+  template<typename ...A, std::size_t ...I>
+  static jerry_value_t call(void (*function)(A...), const jerry_value_t args[], Indices<I...>)
+  {
+    function(Converter<typename std::decay<A>::type>::fromJs(args[I])...);
+    return jerry_create_undefined();
+  }
+};
+
+
+}
+
+
+// the marshalling trampoline, instantiated once per distinct function type
+template<typename F>
+struct Signature;
+
+
+template<typename R, typename ...A>
+struct Signature<R(A...)>
+{
+  static jerry_value_t handler(
+    const jerry_value_t function_obj,
+    const jerry_value_t /*this_val*/,
+    const jerry_value_t args[],
+    const jerry_length_t argc)
+  {
+    void *ptr = nullptr;
+    if (!jerry_get_object_native_pointer(function_obj, &ptr, detail::bindingInfo()))
+      throw std::string("rtjs::Signature::handler called without a binding");
+
+    const Binding *binding = static_cast<const Binding *>(ptr);
+
+    if (argc != sizeof...(A))
+      throw std::string(binding->mName) + " called with invalid argument count " + std::to_string(argc)
+          + " (must be " + std::to_string(sizeof...(A)) + ")";
+
+    R (*function)(A...) = *static_cast<R (* const *)(A...)>(binding->mFunction);
+    return detail::Call<R>::call(function, args, typename detail::MakeIndices<sizeof...(A)>::type());
+  }
+};
+
+
+// sets one function property on target per table entry
+template<std::size_t N>
+void registerBindings(const jerry_value_t target, const Binding (&bindings)[N])
+{
+  for (const Binding &binding : bindings)
+  {
+    jerry_value_t name = jerry_create_string((const jerry_char_t *)binding.mName);
+    jerry_value_t function = jerry_create_external_function(binding.mHandler);
+    jerry_set_object_native_pointer(function, const_cast<Binding *>(&binding), detail::bindingInfo());
+    jerry_release_value(jerry_set_property(target, name, function));
+    jerry_release_value(name);
+    jerry_release_value(function);
+  }
+}
+
+
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <jerryscript.h>
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+
+namespace rtjs
+{
+
+
+// bounds how long script evaluation may run. the vm calls back every frequency-th checkpoint
+// (backward jumps and calls, needs an engine built with JERRY_VM_EXEC_STOP), and an evaluation past
+// its deadline or checkpoint budget gets aborted with a RangeError carrying message().
+// the error is thrown again at every later checkpoint until end(), so scripts cannot catch their way
+// past it. one budget per js thread, native code called by scripts checks it with checkCurrent()
+class ExecutionBudget
+{
+public:
+  // frequency: checkpoints per callback, lower aborts sooner and costs more
+  explicit ExecutionBudget(uint32_t frequency = 1024)
+    : mPrevious(current())
+    , mFrequency(frequency)
+  {
+    current() = this;
+    jerry_set_vm_exec_stop_callback(stopCallback, this, frequency);
+  }
+
+  ~ExecutionBudget()
+  {
+    current() = mPrevious;
+    jerry_set_vm_exec_stop_callback(mPrevious ? stopCallback : nullptr, mPrevious, mPrevious ? mPrevious->mFrequency : 1);
+  }
+
+  ExecutionBudget(const ExecutionBudget &) = delete;
+  ExecutionBudget &operator=(const ExecutionBudget &) = delete;
+
+  // nanoseconds, CLOCK_MONOTONIC goes through the vdso and doesn't enter the kernel
+  static uint64_t now()
+  {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+  }
+
+  static const char *message()
+  {
+    return "rtjs: execution budget exceeded";
+  }
+
+  // the budget of this thread, nullptr if there is none
+  static ExecutionBudget *&current()
+  {
+    static thread_local ExecutionBudget *budget = nullptr;
+    return budget;
+  }
+
+  // limits for the evaluation(s) until end(), 0: unlimited
+  void begin(uint64_t timeoutNs, uint64_t checkpoints = 0)
+  {
+    mDeadline = timeoutNs ? now() + timeoutNs : 0;
+    mMaxCheckpoints = checkpoints;
+    mCheckpoints = 0;
+    mExceeded = false;
+    mActive = true;
+  }
+
+  void end()
+  {
+    mActive = false;
+  }
+
+  // whether the running evaluation overran, stays true until the next begin()
+  bool exceeded()
+  {
+    if (mActive && !mExceeded && mDeadline && now() >= mDeadline)
+      mExceeded = true;
+    return mExceeded;
+  }
+
+  // vm callbacks in the running evaluation so far
+  uint64_t checkpoints() const
+  {
+    return mCheckpoints;
+  }
+
+  // whether the evaluation running on this thread overran, for code that must not throw
+  static bool currentExceeded()
+  {
+    ExecutionBudget *budget = current();
+    return budget && budget->exceeded();
+  }
+
+  // for long running native code, throws like the generated handlers do
+  static void checkCurrent()
+  {
+    if (currentExceeded())
+      throw std::string(message());
+  }
+
+private:
+  struct State
+  {
+    uint64_t mDeadline;
+    uint64_t mMaxCheckpoints;
+    uint64_t mCheckpoints;
+    bool mExceeded;
+  };
+
+  State state() const
+  {
+    return { mDeadline, mMaxCheckpoints, mCheckpoints, mExceeded };
+  }
+
+  void restore(const State &state)
+  {
+    mDeadline = state.mDeadline;
+    mMaxCheckpoints = state.mMaxCheckpoints;
+    mCheckpoints = state.mCheckpoints + mCheckpoints; // the nested evaluation ran within the outer one
+    mExceeded = state.mExceeded || mExceeded;
+    mActive = true;
+  }
+
+public:
+  // begin() / end() for one evaluation, restoring the limits of an enclosing one
+  class Scope
+  {
+  public:
+    Scope(ExecutionBudget &budget, uint64_t timeoutNs, uint64_t checkpoints = 0)
+      : mBudget(budget)
+      , mNested(budget.mActive)
+      , mSaved(budget.state())
+    {
+      budget.begin(timeoutNs, checkpoints);
+    }
+
+    ~Scope()
+    {
+      if (mNested)
+        mBudget.restore(mSaved);
+      else
+        mBudget.end();
+    }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    ExecutionBudget &mBudget;
+    const bool mNested;
+    const State mSaved;
+  };
+
+private:
+  static jerry_value_t stopCallback(void *user)
+  {
+    ExecutionBudget *budget = static_cast<ExecutionBudget *>(user);
+    if (!budget->mActive)
+      return jerry_create_undefined();
+
+    budget->mCheckpoints++;
+    if (budget->mMaxCheckpoints && budget->mCheckpoints > budget->mMaxCheckpoints)
+      budget->mExceeded = true;
+
+    if (!budget->exceeded())
+      return jerry_create_undefined();
+
+    return jerry_create_error(JERRY_ERROR_RANGE, (const jerry_char_t *)message());
+  }
+
+  ExecutionBudget *mPrevious;
+  const uint32_t mFrequency;
+  uint64_t mDeadline = 0;
+  uint64_t mMaxCheckpoints = 0;
+  uint64_t mCheckpoints = 0;
+  bool mExceeded = false;
+  bool mActive = false;
+};
+
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <jerryscript.h>
+
+#include <functional>
+
+
+namespace rtjs
+{
+
+
+// keeps a js function alive for as long as native code may call it
+class FunctionRef
+{
+public:
+  explicit FunctionRef(const jerry_value_t function)
+    : mFunction(jerry_acquire_value(function))
+  {
+  }
+
+  ~FunctionRef()
+  {
+    jerry_release_value(mFunction);
+  }
+
+  FunctionRef(const FunctionRef &) = delete;
+  FunctionRef &operator=(const FunctionRef &) = delete;
+
+  const jerry_value_t mFunction;
+};
+
+
+// the userdata a [[rtjs::retain_callback]] binding passed along with a function pointer belongs to the
+// native code it was passed to. once that won't call the function anymore, it hands the userdata back
+// here, on the js thread. bindings without the attribute release the function when the call returns
+inline void releaseCallback(void *userData)
+{
+  delete static_cast<FunctionRef *>(userData);
+}
+
+
+// errors of js functions called back by native code, which only gets a default result. like
+// EventLoop::setErrorHandler() the handler gets the error value and doesn't release it
+typedef std::function<void(jerry_value_t error)> CallbackErrorHandler;
+
+inline CallbackErrorHandler &callbackErrorHandler()
+{
+  static CallbackErrorHandler handler;
+  return handler;
+}
+
+inline void setCallbackErrorHandler(CallbackErrorHandler handler)
+{
+  callbackErrorHandler() = std::move(handler);
+}
+
+// for the generated callbacks, dropped without a handler
+inline void reportCallbackError(const jerry_value_t error)
+{
+  if (callbackErrorHandler())
+    callbackErrorHandler()(error);
+}
+
+
+}
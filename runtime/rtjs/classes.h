@@ -0,0 +1,90 @@
+#pragma once
+
+#include <jerryscript.h>
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace rtjs
+{
+
+
+// where the Base subobject lies in an object of class Derived, by native info of the class the wrapper
+// was made for. the generated table of each class lists the class itself and every class derived from
+// it, so a base class handler gets its this pointer with static offsets only (no rtti, no dynamic_cast)
+struct Upcast
+{
+  const jerry_object_native_info_t *mInfo;
+  ptrdiff_t mOffset;
+};
+
+
+// static_cast<Base *>() on a Derived * as a byte offset, a constant once the compiler is done with it.
+// virtual bases have no fixed offset, they don't get here
+template<typename Derived, typename Base>
+inline ptrdiff_t upcastOffset()
+{
+  alignas(Derived) static char storage[sizeof(Derived)]; // just an address, no object lives there
+  Derived *derived = reinterpret_cast<Derived *>(storage);
+  return reinterpret_cast<char *>(static_cast<Base *>(derived)) - storage;
+}
+
+
+// the entry of the class value wraps, with the native pointer as set on it (ptr), nullptr if it wraps none
+inline const Upcast *findUpcast(const jerry_value_t value, const Upcast *upcasts, size_t count, void *&ptr)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    if (jerry_get_object_native_pointer(value, &ptr, upcasts[i].mInfo))
+      return &upcasts[i];
+  }
+  return nullptr;
+}
+
+
+// the native pointer of value as the class upcasts[0] is for, nullptr if value wraps none of the classes
+inline void *nativeAs(const jerry_value_t value, const Upcast *upcasts, size_t count)
+{
+  void *ptr = nullptr;
+  const Upcast *upcast = findUpcast(value, upcasts, count, ptr);
+  return upcast ? static_cast<char *>(ptr) + upcast->mOffset : nullptr;
+}
+
+
+// js objects have a single prototype: the first base class is the prototype of a class prototype, the
+// properties of any further one (and of its own bases) are defined on proto as well. the function
+// objects are shared, not copied, and names proto already has (own or inherited) stay as they are
+inline void mixinPrototype(const jerry_value_t proto, const jerry_value_t baseProto)
+{
+  jerry_value_t current = jerry_acquire_value(baseProto);
+  while (jerry_value_is_object(current))
+  {
+    jerry_value_t keys = jerry_get_object_keys(current);
+    const uint32_t length = jerry_get_array_length(keys);
+    for (uint32_t i = 0; i < length; i++)
+    {
+      jerry_value_t key = jerry_get_property_by_index(keys, i);
+      jerry_value_t has = jerry_has_property(proto, key);
+
+      jerry_property_descriptor_t desc;
+      if (!jerry_get_boolean_value(has) && jerry_get_own_property_descriptor(current, key, &desc))
+      {
+        jerry_release_value(jerry_define_own_property(proto, key, &desc));
+        jerry_free_property_descriptor_fields(&desc);
+      }
+
+      jerry_release_value(has);
+      jerry_release_value(key);
+    }
+    jerry_release_value(keys);
+
+    jerry_value_t next = jerry_get_prototype(current);
+    jerry_release_value(current);
+    current = next;
+  }
+  jerry_release_value(current);
+}
+
+
+}
@@ -0,0 +1,371 @@
+#pragma once
+
+#include <rtjs/taskqueue.h>
+#include <rtjs/workerpool.h>
+
+#include <jerryscript.h>
+
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+
+namespace rtjs
+{
+
+
+// single threaded event loop for one js context:
+// - timers (setTimeout / setInterval) share one timerfd, armed for the earliest deadline
+// - fd readiness callbacks through epoll
+// - the job queue (promise reactions) gets drained once per tick, not per callback
+// blocks in epoll_wait while there is nothing to do
+class EventLoop
+{
+public:
+  typedef std::function<void(uint32_t events)> FdCallback;
+  typedef std::function<void(jerry_value_t error)> ErrorHandler;
+  typedef std::function<void()> IdleHandler;
+
+  EventLoop()
+    : mEpollFd(epoll_create1(EPOLL_CLOEXEC))
+    , mTimerFd(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC))
+  {
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = mTimerFd;
+    epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mTimerFd, &event);
+  }
+
+  ~EventLoop()
+  {
+    for (auto &timer : mTimers)
+      jerry_release_value(timer.second.mCallback);
+
+    close(mTimerFd);
+    close(mEpollFd);
+  }
+
+  EventLoop(const EventLoop &) = delete;
+  EventLoop &operator=(const EventLoop &) = delete;
+
+  // setTimeout, setInterval, clearTimeout and clearInterval on the global object
+  void registerBindings()
+  {
+    setGlobal("setTimeout", setTimeoutHandler);
+    setGlobal("setInterval", setIntervalHandler);
+    setGlobal("clearTimeout", clearTimerHandler);
+    setGlobal("clearInterval", clearTimerHandler);
+  }
+
+  // called with the (non error flagged) exception of failed callbacks, they are dropped otherwise
+  void setErrorHandler(ErrorHandler handler)
+  {
+    mErrorHandler = std::move(handler);
+  }
+
+  // called after every tick that ran callbacks, once the job queue is drained: a point
+  // between requests where e.g. a gc pause doesn't hurt (see HeapMonitor::idle())
+  void setIdleHandler(IdleHandler handler)
+  {
+    mIdleHandler = std::move(handler);
+  }
+
+  // the callback is acquired, returns the timer id
+  uint32_t addTimer(const jerry_value_t callback, double delayMs, bool repeat)
+  {
+    if (delayMs < 0 || delayMs != delayMs) // negative or NaN
+      delayMs = 0;
+
+    const uint32_t id = ++mLastTimerId;
+    const uint64_t interval = (uint64_t)(delayMs * 1000000.0);
+    mTimers[id] = { jerry_acquire_value(callback), interval, repeat };
+    schedule(id, now() + interval);
+    return id;
+  }
+
+  void removeTimer(uint32_t id)
+  {
+    auto it = mTimers.find(id);
+    if (it == mTimers.end())
+      return;
+
+    jerry_release_value(it->second.mCallback);
+    mTimers.erase(it); // the deadline entry is dropped lazily
+  }
+
+  // keepAlive: whether run() keeps running while only this fd is watched
+  void watchFd(int fd, uint32_t events, FdCallback callback, bool keepAlive = true)
+  {
+    epoll_event event = {};
+    event.events = events;
+    event.data.fd = fd;
+
+    const bool known = mWatches.count(fd) > 0;
+    mWatches[fd] = { std::move(callback), keepAlive };
+    epoll_ctl(mEpollFd, known ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &event);
+  }
+
+  void unwatchFd(int fd)
+  {
+    if (mWatches.erase(fd))
+      epoll_ctl(mEpollFd, EPOLL_CTL_DEL, fd, nullptr);
+  }
+
+  // settle promises of async bindings as their calls complete, doesn't keep run() alive
+  void attachWorkerPool(WorkerPool &pool)
+  {
+    watchFd(pool.notifyFd(), EPOLLIN, [&pool](uint32_t) { pool.runCompletions(); }, false);
+  }
+
+  // run tasks posted from other threads, at most batch per tick so timers and fds don't starve.
+  // doesn't keep run() alive
+  void attachTaskQueue(TaskQueue &queue, size_t batch = 256)
+  {
+    watchFd(queue.notifyFd(), EPOLLIN, [&queue, batch](uint32_t) { queue.drain(batch); }, false);
+  }
+
+  // until stop() is called or there are neither timers nor keep-alive fds left
+  void run()
+  {
+    mStopped = false;
+
+    while (!mStopped && alive())
+      runOnce(-1);
+  }
+
+  // one tick: waits up to timeoutMs (-1 = forever) for events, runs all due callbacks,
+  // then drains the job queue once
+  void runOnce(int timeoutMs)
+  {
+    epoll_event events[64];
+    const int count = epoll_wait(mEpollFd, events, 64, timeoutMs);
+
+    bool ran = false;
+    for (int i = 0; i < count; i++)
+    {
+      if (events[i].data.fd == mTimerFd)
+      {
+        uint64_t expirations;
+        ssize_t readBytes = read(mTimerFd, &expirations, sizeof(expirations));
+        (void)readBytes;
+
+        ran |= runTimers();
+        continue;
+      }
+
+      auto it = mWatches.find(events[i].data.fd);
+      if (it == mWatches.end())
+        continue;
+
+      FdCallback callback(it->second.mCallback); // the callback may unwatch itself
+      callback(events[i].events);
+      ran = true;
+    }
+
+    if (!ran)
+      return;
+
+    check(jerry_run_all_enqueued_jobs());
+
+    if (mIdleHandler)
+      mIdleHandler();
+  }
+
+  void stop()
+  {
+    mStopped = true;
+  }
+
+private:
+  struct Timer
+  {
+    jerry_value_t mCallback;
+    uint64_t mInterval; // ns
+    bool mRepeat;
+  };
+
+  struct Deadline
+  {
+    uint64_t mTime; // ns, CLOCK_MONOTONIC
+    uint32_t mId;
+
+    bool operator>(const Deadline &other) const
+    {
+      return mTime > other.mTime;
+    }
+  };
+
+  struct Watch
+  {
+    FdCallback mCallback;
+    bool mKeepAlive;
+  };
+
+  static uint64_t now()
+  {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+  }
+
+  static const jerry_object_native_info_t *nativeInfo()
+  {
+    static const jerry_object_native_info_t info = { nullptr };
+    return &info;
+  }
+
+  static EventLoop *fromFunction(const jerry_value_t function_obj)
+  {
+    void *ptr = nullptr;
+    jerry_get_object_native_pointer(function_obj, &ptr, nativeInfo());
+    return static_cast<EventLoop *>(ptr);
+  }
+
+  static jerry_value_t addTimerHandler(const jerry_value_t function_obj, const jerry_value_t args[], const jerry_length_t argc, bool repeat)
+  {
+    if (argc < 1 || !jerry_value_is_function(args[0]))
+      return jerry_create_error(JERRY_ERROR_TYPE, (const jerry_char_t *)"callback function expected");
+
+    const double delay = argc > 1 && jerry_value_is_number(args[1]) ? jerry_get_number_value(args[1]) : 0;
+    return jerry_create_number(fromFunction(function_obj)->addTimer(args[0], delay, repeat));
+  }
+
+  static jerry_value_t setTimeoutHandler(const jerry_value_t function_obj, const jerry_value_t, const jerry_value_t args[], const jerry_length_t argc)
+  {
+    return addTimerHandler(function_obj, args, argc, false);
+  }
+
+  static jerry_value_t setIntervalHandler(const jerry_value_t function_obj, const jerry_value_t, const jerry_value_t args[], const jerry_length_t argc)
+  {
+    return addTimerHandler(function_obj, args, argc, true);
+  }
+
+  static jerry_value_t clearTimerHandler(const jerry_value_t function_obj, const jerry_value_t, const jerry_value_t args[], const jerry_length_t argc)
+  {
+    if (argc > 0 && jerry_value_is_number(args[0]))
+      fromFunction(function_obj)->removeTimer((uint32_t)jerry_get_number_value(args[0]));
+    return jerry_create_undefined();
+  }
+
+  void setGlobal(const char *name, jerry_external_handler_t handler)
+  {
+    jerry_value_t global = jerry_get_global_object();
+    jerry_value_t prop_name = jerry_create_string((const jerry_char_t *)name);
+    jerry_value_t func_val = jerry_create_external_function(handler);
+    jerry_set_object_native_pointer(func_val, this, nativeInfo());
+    jerry_release_value(jerry_set_property(global, prop_name, func_val));
+    jerry_release_value(func_val);
+    jerry_release_value(prop_name);
+    jerry_release_value(global);
+  }
+
+  bool alive() const
+  {
+    if (!mTimers.empty())
+      return true;
+
+    for (const auto &watch : mWatches)
+    {
+      if (watch.second.mKeepAlive)
+        return true;
+    }
+
+    return false;
+  }
+
+  void schedule(uint32_t id, uint64_t time)
+  {
+    const bool earliest = mDeadlines.empty() || time < mDeadlines.top().mTime;
+    mDeadlines.push({ time, id });
+
+    if (earliest)
+      arm();
+  }
+
+  void arm()
+  {
+    itimerspec spec = {};
+    if (!mDeadlines.empty()) // disarmed otherwise
+    {
+      const uint64_t time = mDeadlines.top().mTime > 0 ? mDeadlines.top().mTime : 1;
+      spec.it_value.tv_sec = (time_t)(time / 1000000000ull);
+      spec.it_value.tv_nsec = (long)(time % 1000000000ull);
+    }
+    timerfd_settime(mTimerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+  }
+
+  // all timers due by now in one go, returns whether any callback ran
+  bool runTimers()
+  {
+    const uint64_t time = now();
+    std::vector<uint32_t> due;
+
+    while (!mDeadlines.empty() && mDeadlines.top().mTime <= time)
+    {
+      due.push_back(mDeadlines.top().mId);
+      mDeadlines.pop();
+    }
+
+    for (uint32_t id : due)
+    {
+      auto it = mTimers.find(id);
+      if (it == mTimers.end()) // cleared
+        continue;
+
+      jerry_value_t callback = jerry_acquire_value(it->second.mCallback);
+
+      if (it->second.mRepeat)
+        mDeadlines.push({ time + (it->second.mInterval > 0 ? it->second.mInterval : 1000000), id });
+      else
+      {
+        jerry_release_value(it->second.mCallback);
+        mTimers.erase(it);
+      }
+
+      jerry_value_t undefined = jerry_create_undefined();
+      check(jerry_call_function(callback, undefined, nullptr, 0));
+      jerry_release_value(undefined);
+      jerry_release_value(callback);
+    }
+
+    // drop deadlines of cleared timers from the top, so the timerfd isn't armed for nothing
+    while (!mDeadlines.empty() && mTimers.count(mDeadlines.top().mId) == 0)
+      mDeadlines.pop();
+
+    arm();
+    return !due.empty();
+  }
+
+  void check(jerry_value_t result)
+  {
+    if (jerry_value_is_error(result) && mErrorHandler)
+    {
+      jerry_value_t error = jerry_get_value_from_error(result, true);
+      mErrorHandler(error);
+      jerry_release_value(error);
+      return;
+    }
+
+    jerry_release_value(result);
+  }
+
+  int mEpollFd;
+  int mTimerFd;
+  bool mStopped = false;
+  uint32_t mLastTimerId = 0;
+  std::unordered_map<uint32_t, Timer> mTimers;
+  std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> mDeadlines;
+  std::unordered_map<int, Watch> mWatches;
+  ErrorHandler mErrorHandler;
+  IdleHandler mIdleHandler;
+};
+
+
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <jerryscript.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+
+namespace rtjs
+{
+
+
+// engine heap telemetry and gc policy: collects at points the embedder chooses (idle()) instead of
+// whenever the allocator runs short, and reports threshold crossings.
+// heap numbers need an engine built with JERRY_MEM_STATS, without it usage().mValid is false
+// and only the gc policy works
+class HeapMonitor
+{
+public:
+  struct Usage
+  {
+    bool mValid; // JERRY_MEM_STATS
+    size_t mSize; // of the engine heap
+    size_t mAllocated;
+    size_t mPeak;
+    uint64_t mCollections; // by this monitor
+    size_t mLastFreed; // by the last of those
+  };
+
+  // above: whether usage went above the threshold (false: back below it)
+  typedef std::function<void(const Usage &usage, bool above)> ThresholdCallback;
+
+  Usage usage() const
+  {
+    jerry_heap_stats_t stats = {};
+    Usage usage = {};
+    usage.mValid = jerry_get_memory_stats(&stats);
+    usage.mSize = stats.size;
+    usage.mAllocated = stats.allocated_bytes;
+    usage.mPeak = stats.peak_allocated_bytes;
+    usage.mCollections = mCollections;
+    usage.mLastFreed = mLastFreed;
+    return usage;
+  }
+
+  // JERRY_GC_PRESSURE_LOW: only free what is cheap to free, JERRY_GC_PRESSURE_HIGH: everything possible
+  void setPressure(jerry_gc_mode_t pressure)
+  {
+    mPressure = pressure;
+  }
+
+  // idle() collects once the heap holds more than bytes (0: every time, also without JERRY_MEM_STATS)
+  void setCollectAbove(size_t bytes)
+  {
+    mCollectAbove = bytes;
+    mCollectOnIdle = true;
+  }
+
+  void addThreshold(size_t bytes, ThresholdCallback callback)
+  {
+    mThresholds.push_back({ bytes, std::move(callback), false });
+  }
+
+  void collect()
+  {
+    const size_t before = usage().mAllocated;
+    jerry_gc(mPressure);
+    const size_t after = usage().mAllocated;
+
+    mCollections++;
+    mLastFreed = before > after ? before - after : 0;
+    check();
+  }
+
+  // to be called at points where a gc pause doesn't hurt, e.g. between requests or after batch calls
+  void idle()
+  {
+    const Usage current(usage());
+    if (mCollectOnIdle && (current.mValid ? current.mAllocated >= mCollectAbove : mCollectAbove == 0))
+      collect();
+    else
+      check();
+  }
+
+  // fires the callbacks of the thresholds crossed since the last check
+  void check()
+  {
+    const Usage current(usage());
+    if (!current.mValid)
+      return;
+
+    for (Threshold &threshold : mThresholds)
+    {
+      const bool above = current.mAllocated > threshold.mBytes;
+      if (above == threshold.mAbove)
+        continue;
+
+      threshold.mAbove = above;
+      threshold.mCallback(current, above);
+    }
+  }
+
+  // name.usage() and name.gc([high pressure]) on the global object
+  void registerBindings(const char *name = "heap")
+  {
+    jerry_value_t obj = jerry_create_object();
+    setFunction(obj, "usage", usageHandler);
+    setFunction(obj, "gc", gcHandler);
+
+    jerry_value_t global = jerry_get_global_object();
+    jerry_value_t prop_name = jerry_create_string((const jerry_char_t *)name);
+    jerry_release_value(jerry_set_property(global, prop_name, obj));
+    jerry_release_value(prop_name);
+    jerry_release_value(global);
+    jerry_release_value(obj);
+  }
+
+private:
+  struct Threshold
+  {
+    size_t mBytes;
+    ThresholdCallback mCallback;
+    bool mAbove;
+  };
+
+  static const jerry_object_native_info_t *nativeInfo()
+  {
+    static const jerry_object_native_info_t info = { nullptr };
+    return &info;
+  }
+
+  static HeapMonitor *fromFunction(const jerry_value_t function_obj)
+  {
+    void *ptr = nullptr;
+    jerry_get_object_native_pointer(function_obj, &ptr, nativeInfo());
+    return static_cast<HeapMonitor *>(ptr);
+  }
+
+  static void setNumber(const jerry_value_t obj, const char *name, double number)
+  {
+    jerry_value_t prop_name = jerry_create_string((const jerry_char_t *)name);
+    jerry_value_t value = jerry_create_number(number);
+    jerry_release_value(jerry_set_property(obj, prop_name, value));
+    jerry_release_value(prop_name);
+    jerry_release_value(value);
+  }
+
+  static jerry_value_t usageHandler(const jerry_value_t function_obj, const jerry_value_t, const jerry_value_t [], const jerry_length_t)
+  {
+    const Usage usage(fromFunction(function_obj)->usage());
+    if (!usage.mValid)
+      return jerry_create_undefined();
+
+    jerry_value_t obj = jerry_create_object();
+    setNumber(obj, "size", (double)usage.mSize);
+    setNumber(obj, "allocated", (double)usage.mAllocated);
+    setNumber(obj, "peak", (double)usage.mPeak);
+    setNumber(obj, "collections", (double)usage.mCollections);
+    setNumber(obj, "lastFreed", (double)usage.mLastFreed);
+    return obj;
+  }
+
+  static jerry_value_t gcHandler(const jerry_value_t function_obj, const jerry_value_t, const jerry_value_t args[], const jerry_length_t argc)
+  {
+    HeapMonitor *monitor = fromFunction(function_obj);
+    const jerry_gc_mode_t pressure = monitor->mPressure;
+
+    if (argc > 0)
+      monitor->mPressure = jerry_value_to_boolean(args[0]) ? JERRY_GC_PRESSURE_HIGH : JERRY_GC_PRESSURE_LOW;
+
+    monitor->collect();
+    monitor->mPressure = pressure;
+    return jerry_create_undefined();
+  }
+
+  void setFunction(const jerry_value_t obj, const char *name, jerry_external_handler_t handler)
+  {
+    jerry_value_t prop_name = jerry_create_string((const jerry_char_t *)name);
+    jerry_value_t func_val = jerry_create_external_function(handler);
+    jerry_set_object_native_pointer(func_val, this, nativeInfo());
+    jerry_release_value(jerry_set_property(obj, prop_name, func_val));
+    jerry_release_value(func_val);
+    jerry_release_value(prop_name);
+  }
+
+  jerry_gc_mode_t mPressure = JERRY_GC_PRESSURE_LOW;
+  bool mCollectOnIdle = false;
+  size_t mCollectAbove = 0;
+  uint64_t mCollections = 0;
+  size_t mLastFreed = 0;
+  std::vector<Threshold> mThresholds;
+};
+
+
+}
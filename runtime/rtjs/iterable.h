@@ -0,0 +1,255 @@
+#pragma once
+
+#include <jerryscript.h>
+
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+
+namespace rtjs
+{
+
+
+// a native container as a js iterable whose elements get converted one at a time, when a script pulls
+// them, instead of all at once into an array. values() and [Symbol.iterator]() give iterators whose
+// next() converts the next element with Convert::toJs(element), random access containers also have
+// get(i) and length. own() moves the container into the js object, borrow() refers to one that has to
+// outlive it and must not change while scripts iterate it.
+// the prototypes are made by registerPrototypes(), once per engine init
+template<typename Container, typename Convert>
+class Iterable
+{
+public:
+  typedef typename Container::const_iterator Iterator;
+
+  static const bool randomAccess = std::is_base_of<std::random_access_iterator_tag,
+      typename std::iterator_traits<Iterator>::iterator_category>::value;
+
+  static jerry_value_t own(Container &&container)
+  {
+    return create(std::make_shared<const Container>(std::move(container)));
+  }
+
+  static jerry_value_t borrow(const Container *container)
+  {
+    if (!container)
+      return jerry_create_null();
+
+    // no control block, the container is not ours to delete
+    return create(std::shared_ptr<const Container>(std::shared_ptr<const Container>(), container));
+  }
+
+  static void registerPrototypes()
+  {
+    iterableProto() = jerry_create_object();
+    setFunction(iterableProto(), "values", valuesHandler);
+    setIteratorFunction(iterableProto(), valuesHandler);
+
+    if (randomAccess)
+    {
+      setFunction(iterableProto(), "get", getHandler);
+
+      jerry_property_descriptor_t desc;
+      jerry_init_property_descriptor_fields(&desc);
+      desc.is_get_defined = true;
+      desc.getter = jerry_create_external_function(lengthHandler);
+
+      jerry_value_t prop_name = jerry_create_string((const jerry_char_t *)"length");
+      jerry_release_value(jerry_define_own_property(iterableProto(), prop_name, &desc));
+      jerry_release_value(prop_name);
+      jerry_free_property_descriptor_fields(&desc);
+    }
+
+    iteratorProto() = jerry_create_object();
+    setFunction(iteratorProto(), "next", nextHandler);
+    setIteratorFunction(iteratorProto(), selfHandler); // iterators are iterable themselves
+  }
+
+  static void releasePrototypes()
+  {
+    jerry_release_value(iterableProto());
+    jerry_release_value(iteratorProto());
+    iterableProto() = 0;
+    iteratorProto() = 0;
+  }
+
+private:
+  typedef std::shared_ptr<const Container> Holder;
+
+  struct Cursor
+  {
+    Holder mContainer; // keeps an owned container alive after its iterable is collected
+    Iterator mPos;
+  };
+
+  static void freeHolder(void *ptr)
+  {
+    delete static_cast<Holder *>(ptr);
+  }
+
+  static void freeCursor(void *ptr)
+  {
+    delete static_cast<Cursor *>(ptr);
+  }
+
+  static const jerry_object_native_info_t *holderInfo()
+  {
+    static const jerry_object_native_info_t info = { freeHolder };
+    return &info;
+  }
+
+  static const jerry_object_native_info_t *cursorInfo()
+  {
+    static const jerry_object_native_info_t info = { freeCursor };
+    return &info;
+  }
+
+  static jerry_value_t &iterableProto()
+  {
+    static jerry_value_t proto = 0;
+    return proto;
+  }
+
+  static jerry_value_t &iteratorProto()
+  {
+    static jerry_value_t proto = 0;
+    return proto;
+  }
+
+  static jerry_value_t create(Holder &&container)
+  {
+    jerry_value_t obj = jerry_create_object();
+    jerry_set_object_native_pointer(obj, new Holder(std::move(container)), holderInfo());
+    jerry_release_value(jerry_set_prototype(obj, iterableProto()));
+    return obj;
+  }
+
+  static const Holder *holderOf(const jerry_value_t this_val)
+  {
+    void *ptr = nullptr;
+    if (!jerry_get_object_native_pointer(this_val, &ptr, holderInfo()))
+      return nullptr;
+    return static_cast<Holder *>(ptr);
+  }
+
+  static jerry_value_t typeError(const char *message)
+  {
+    return jerry_create_error(JERRY_ERROR_TYPE, (const jerry_char_t *)message);
+  }
+
+  // the converters throw like the generated handlers do
+  static jerry_value_t convert(const typename Container::value_type &element)
+  {
+    try
+    {
+      return Convert::toJs(element);
+    }
+    catch (const std::string &msg)
+    {
+      return jerry_create_error(JERRY_ERROR_COMMON, (const jerry_char_t *)msg.c_str());
+    }
+    catch (const std::exception &e)
+    {
+      return jerry_create_error(JERRY_ERROR_COMMON, (const jerry_char_t *)e.what());
+    }
+  }
+
+  static jerry_value_t valuesHandler(const jerry_value_t, const jerry_value_t this_val, const jerry_value_t [], const jerry_length_t)
+  {
+    const Holder *container = holderOf(this_val);
+    if (!container)
+      return typeError("values() called on something else than a native iterable");
+
+    jerry_value_t obj = jerry_create_object();
+    jerry_set_object_native_pointer(obj, new Cursor { *container, (*container)->begin() }, cursorInfo());
+    jerry_release_value(jerry_set_prototype(obj, iteratorProto()));
+    return obj;
+  }
+
+  static jerry_value_t nextHandler(const jerry_value_t, const jerry_value_t this_val, const jerry_value_t [], const jerry_length_t)
+  {
+    void *ptr = nullptr;
+    if (!jerry_get_object_native_pointer(this_val, &ptr, cursorInfo()))
+      return typeError("next() called on something else than a native iterator");
+
+    Cursor *cursor = static_cast<Cursor *>(ptr);
+    const bool done = cursor->mPos == cursor->mContainer->end();
+
+    jerry_value_t value = done ? jerry_create_undefined() : convert(*cursor->mPos);
+    if (jerry_value_is_error(value))
+      return value;
+
+    if (!done)
+      ++cursor->mPos;
+
+    jerry_value_t result = jerry_create_object();
+    setProperty(result, "value", value);
+    setProperty(result, "done", jerry_create_boolean(done));
+    return result;
+  }
+
+  static jerry_value_t selfHandler(const jerry_value_t, const jerry_value_t this_val, const jerry_value_t [], const jerry_length_t)
+  {
+    return jerry_acquire_value(this_val);
+  }
+
+  // undefined outside of the container, like arrays
+  static jerry_value_t getHandler(const jerry_value_t, const jerry_value_t this_val, const jerry_value_t args[], const jerry_length_t argc)
+  {
+    const Holder *container = holderOf(this_val);
+    if (!container)
+      return typeError("get() called on something else than a native iterable");
+
+    if (argc < 1 || !jerry_value_is_number(args[0]))
+      return typeError("get() needs an index");
+
+    const double index = jerry_get_number_value(args[0]);
+    if (!(index >= 0 && index < (double)(*container)->size()))
+      return jerry_create_undefined();
+
+    return convert(*std::next((*container)->begin(), (typename Container::difference_type)index));
+  }
+
+  static jerry_value_t lengthHandler(const jerry_value_t, const jerry_value_t this_val, const jerry_value_t [], const jerry_length_t)
+  {
+    const Holder *container = holderOf(this_val);
+    if (!container)
+      return typeError("length read on something else than a native iterable");
+
+    return jerry_create_number((double)(*container)->size());
+  }
+
+  // takes value
+  static void setProperty(const jerry_value_t obj, const char *name, const jerry_value_t value)
+  {
+    jerry_value_t prop_name = jerry_create_string((const jerry_char_t *)name);
+    jerry_release_value(jerry_set_property(obj, prop_name, value));
+    jerry_release_value(prop_name);
+    jerry_release_value(value);
+  }
+
+  static void setFunction(const jerry_value_t obj, const char *name, jerry_external_handler_t handler)
+  {
+    setProperty(obj, name, jerry_create_external_function(handler));
+  }
+
+  // engines built without symbols only get values()
+  static void setIteratorFunction(const jerry_value_t obj, jerry_external_handler_t handler)
+  {
+    if (!jerry_is_feature_enabled(JERRY_FEATURE_SYMBOL))
+      return;
+
+    jerry_value_t symbol = jerry_get_well_known_symbol(JERRY_SYMBOL_ITERATOR);
+    jerry_value_t func_val = jerry_create_external_function(handler);
+    jerry_release_value(jerry_set_property(obj, symbol, func_val));
+    jerry_release_value(func_val);
+    jerry_release_value(symbol);
+  }
+};
+
+
+}
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <jerryscript.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <unistd.h>
+
+
+namespace rtjs
+{
+
+
+// compiled scripts by content hash, so a script that's run again skips the parser:
+// - up to capacity compiled functions are kept, least recently used ones get released first
+// - with a snapshot directory the bytecode is persisted there as well, a later process
+//   (or the same one after eviction) loads it instead of parsing the source. the source is stored
+//   next to it, a snapshot is only run for the very source it was made from
+class ScriptCache
+{
+public:
+  explicit ScriptCache(size_t capacity = 64, const std::string &snapshotDir = std::string())
+    : mCapacity(capacity > 0 ? capacity : 1)
+    , mSnapshotDir(snapshotDir)
+  {
+  }
+
+  ~ScriptCache()
+  {
+    clear();
+  }
+
+  ScriptCache(const ScriptCache &) = delete;
+  ScriptCache &operator=(const ScriptCache &) = delete;
+
+  // result of running the script, the parse error if it doesn't compile. must be released
+  jerry_value_t run(const std::string &source, uint32_t parseOptions = JERRY_PARSE_NO_OPTS)
+  {
+    jerry_value_t function = get(source, parseOptions);
+    if (jerry_value_is_error(function))
+      return function;
+
+    jerry_value_t result = jerry_run(function);
+    jerry_release_value(function);
+    return result;
+  }
+
+  // compiled script, to be run with jerry_run(). must be released
+  jerry_value_t get(const std::string &source, uint32_t parseOptions = JERRY_PARSE_NO_OPTS)
+  {
+    const uint64_t key = hash(source, parseOptions);
+
+    auto it = mIndex.find(key);
+    if (it != mIndex.end() && it->second->mSource == source)
+    {
+      mHits++;
+      mEntries.splice(mEntries.begin(), mEntries, it->second); // most recently used
+      return jerry_acquire_value(it->second->mFunction);
+    }
+
+    mMisses++;
+
+    jerry_value_t function = load(key, source);
+    if (jerry_value_is_error(function))
+    {
+      jerry_release_value(function);
+      function = jerry_parse(nullptr, 0, (const jerry_char_t *)source.data(), source.size(), parseOptions);
+
+      if (jerry_value_is_error(function)) // not cached, the error may be transient (out of memory)
+        return function;
+
+      store(key, source, parseOptions);
+    }
+
+    if (it != mIndex.end()) // hash collision, the newer one wins
+      remove(it->second);
+
+    mEntries.push_front({ key, source, jerry_acquire_value(function) });
+    mIndex[key] = mEntries.begin();
+
+    while (mEntries.size() > mCapacity)
+      remove(std::prev(mEntries.end()));
+
+    return function;
+  }
+
+  void clear()
+  {
+    for (const Entry &entry : mEntries)
+      jerry_release_value(entry.mFunction);
+
+    mEntries.clear();
+    mIndex.clear();
+  }
+
+  size_t hits() const
+  {
+    return mHits;
+  }
+
+  size_t misses() const
+  {
+    return mMisses;
+  }
+
+private:
+  struct Entry
+  {
+    uint64_t mKey;
+    std::string mSource; // to tell hash collisions apart
+    jerry_value_t mFunction;
+  };
+
+  // FNV-1a over the options and the source
+  static uint64_t hash(const std::string &source, uint32_t parseOptions)
+  {
+    uint64_t hash = 14695981039346656037ull ^ parseOptions;
+    for (unsigned char c : source)
+    {
+      hash ^= c;
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+
+  // snapshot files: magic, snapshot size and source size, then the snapshot and the source,
+  // both padded to whole words
+  static const uint32_t snapshotMagic = 0x314a5452; // "RTJ1"
+  static const size_t headerWords = 3;
+
+  static size_t words(size_t bytes)
+  {
+    return (bytes + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+  }
+
+  std::string snapshotPath(uint64_t key) const
+  {
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.snapshot", (unsigned long long)key);
+    return mSnapshotDir + name;
+  }
+
+  // an error value if there is no usable snapshot
+  jerry_value_t load(uint64_t key, const std::string &source) const
+  {
+    if (mSnapshotDir.empty())
+      return jerry_create_error(JERRY_ERROR_COMMON, (const jerry_char_t *)"no snapshot directory");
+
+    FILE *file = fopen(snapshotPath(key).c_str(), "rb");
+    if (!file)
+      return jerry_create_error(JERRY_ERROR_COMMON, (const jerry_char_t *)"no snapshot");
+
+    std::vector<uint32_t> buffer;
+    uint32_t chunk[1024];
+    size_t count;
+    while ((count = fread(chunk, sizeof(uint32_t), 1024, file)) > 0)
+      buffer.insert(buffer.end(), chunk, chunk + count);
+    fclose(file);
+
+    // another script with the same hash, or a file from an older version
+    if (buffer.size() < headerWords || buffer[0] != snapshotMagic || buffer[2] != source.size()
+        || buffer.size() < headerWords + words(buffer[1]) + words(source.size())
+        || memcmp(buffer.data() + headerWords + words(buffer[1]), source.data(), source.size()) != 0)
+      return jerry_create_error(JERRY_ERROR_COMMON, (const jerry_char_t *)"snapshot of another source");
+
+    // without COPY_DATA the function would keep running its bytecode from the buffer, which goes now
+    return jerry_exec_snapshot(buffer.data() + headerWords, buffer[1], 0,
+                               JERRY_SNAPSHOT_EXEC_LOAD_AS_FUNCTION | JERRY_SNAPSHOT_EXEC_COPY_DATA);
+  }
+
+  void store(uint64_t key, const std::string &source, uint32_t parseOptions) const
+  {
+    if (mSnapshotDir.empty() || !jerry_is_feature_enabled(JERRY_FEATURE_SNAPSHOT_SAVE))
+      return;
+
+    const uint32_t snapshotOptions = (parseOptions & JERRY_PARSE_STRICT_MODE) ? JERRY_SNAPSHOT_SAVE_STRICT : 0;
+
+    // bytecode is usually a few times the size of the source
+    std::vector<uint32_t> buffer(source.size() + 1024);
+    for (int attempt = 0; attempt < 4; attempt++, buffer.resize(buffer.size() * 4))
+    {
+      jerry_value_t result = jerry_generate_snapshot(nullptr, 0, (const jerry_char_t *)source.data(), source.size(),
+                                                     snapshotOptions, buffer.data(), buffer.size() * sizeof(uint32_t));
+      if (jerry_value_is_error(result))
+      {
+        jerry_release_value(result);
+        continue;
+      }
+
+      const size_t size = (size_t)jerry_get_number_value(result);
+      jerry_release_value(result);
+
+      // written aside and renamed, so concurrent processes never load a partial snapshot
+      const std::string path(snapshotPath(key));
+      const std::string tmpPath(path + ".tmp" + std::to_string((long long)getpid()));
+      FILE *file = fopen(tmpPath.c_str(), "wb");
+      if (!file)
+        return;
+
+      std::vector<uint32_t> padded(words(source.size()), 0);
+      memcpy(padded.data(), source.data(), source.size());
+
+      const uint32_t header[headerWords] = { snapshotMagic, (uint32_t)size, (uint32_t)source.size() };
+      const bool written = fwrite(header, sizeof(uint32_t), headerWords, file) == headerWords
+          && fwrite(buffer.data(), sizeof(uint32_t), words(size), file) == words(size)
+          && fwrite(padded.data(), sizeof(uint32_t), padded.size(), file) == padded.size();
+      if (fclose(file) == 0 && written)
+        rename(tmpPath.c_str(), path.c_str());
+      else
+        std::remove(tmpPath.c_str());
+
+      return;
+    }
+  }
+
+  void remove(std::list<Entry>::iterator entry)
+  {
+    jerry_release_value(entry->mFunction);
+    mIndex.erase(entry->mKey);
+    mEntries.erase(entry);
+  }
+
+  size_t mCapacity;
+  std::string mSnapshotDir;
+  std::list<Entry> mEntries; // most recently used first
+  std::unordered_map<uint64_t, std::list<Entry>::iterator> mIndex;
+  size_t mHits = 0;
+  size_t mMisses = 0;
+};
+
+
+}
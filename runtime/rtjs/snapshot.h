@@ -0,0 +1,109 @@
+#pragma once
+
+#include <jerryscript.h>
+
+#include <cstdint>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace rtjs
+{
+
+
+// snapshot file mapped read-only, executed in place:
+// the bytecode of static snapshots (jerry-snapshot generate --static, JERRY_SNAPSHOT_SAVE_STATIC)
+// is used straight from the page cache, so it costs no heap, loading doesn't depend on the
+// bundle size and all processes mapping the same file share the same physical pages.
+// non-static snapshots work as well, but the engine copies their bytecode.
+// as the engine keeps pointing into the mapping, it must stay open until jerry_cleanup().
+class MappedSnapshot
+{
+public:
+  MappedSnapshot() = default;
+
+  ~MappedSnapshot()
+  {
+    close();
+  }
+
+  MappedSnapshot(const MappedSnapshot &) = delete;
+  MappedSnapshot &operator=(const MappedSnapshot &) = delete;
+
+  // prefault: map all pages right away (MAP_POPULATE) instead of on first use
+  bool open(const std::string &path, bool prefault = false)
+  {
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+      return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 || st.st_size % sizeof(uint32_t) != 0)
+    {
+      ::close(fd);
+      return false;
+    }
+
+    void *data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED | (prefault ? MAP_POPULATE : 0), fd, 0);
+    ::close(fd); // the mapping keeps the file referenced
+
+    if (data == MAP_FAILED)
+      return false;
+
+    mData = static_cast<const uint32_t *>(data);
+    mSize = (size_t)st.st_size;
+    return true;
+  }
+
+  void close()
+  {
+    if (mData)
+      munmap(const_cast<uint32_t *>(mData), mSize);
+
+    mData = nullptr;
+    mSize = 0;
+  }
+
+  bool isOpen() const
+  {
+    return mData != nullptr;
+  }
+
+  // runs the function at functionIndex of the snapshot, returns its result. must be released
+  jerry_value_t exec(size_t functionIndex = 0, uint32_t options = 0) const
+  {
+    if (!mData)
+      return jerry_create_error(JERRY_ERROR_COMMON, (const jerry_char_t *)"snapshot not open");
+
+    return jerry_exec_snapshot(mData, mSize, functionIndex, options | JERRY_SNAPSHOT_EXEC_ALLOW_STATIC);
+  }
+
+  // the function at functionIndex of the snapshot, to be run with jerry_run(). must be released
+  jerry_value_t load(size_t functionIndex = 0) const
+  {
+    return exec(functionIndex, JERRY_SNAPSHOT_EXEC_LOAD_AS_FUNCTION);
+  }
+
+  const uint32_t *data() const
+  {
+    return mData;
+  }
+
+  size_t size() const
+  {
+    return mSize;
+  }
+
+private:
+  const uint32_t *mData = nullptr;
+  size_t mSize = 0;
+};
+
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <jerryscript.h>
+
+#include <cstdio>
+#include <string>
+
+
+namespace rtjs
+{
+
+
+// soak test: runs source iterations times and fails if the engine heap grew meanwhile.
+// the heap is compared after a warm-up and a full gc before and after, so only values that are never
+// given back count. needs an engine built with JERRY_MEM_STATS, otherwise only errors are checked
+inline bool soak(const std::string &source, unsigned long iterations, size_t toleranceBytes = 0)
+{
+  jerry_value_t script = jerry_parse(nullptr, 0, (const jerry_char_t *)source.data(), source.size(), JERRY_PARSE_NO_OPTS);
+  if (jerry_value_is_error(script))
+  {
+    fprintf(stderr, "rtjs soak: cannot parse '%s'\n", source.c_str());
+    jerry_release_value(script);
+    return false;
+  }
+
+  auto run = [&script, &source](unsigned long count)
+  {
+    for (unsigned long i = 0; i < count; i++)
+    {
+      jerry_value_t result = jerry_run(script);
+      if (jerry_value_is_error(result))
+      {
+        fprintf(stderr, "rtjs soak: '%s' failed in iteration %lu\n", source.c_str(), i);
+        jerry_release_value(result);
+        return false;
+      }
+      jerry_release_value(result);
+
+      // promises, if any
+      jerry_release_value(jerry_run_all_enqueued_jobs());
+    }
+    return true;
+  };
+
+  auto heap = []() -> size_t
+  {
+    jerry_heap_stats_t stats = {};
+    jerry_gc(JERRY_GC_PRESSURE_HIGH);
+    return jerry_get_memory_stats(&stats) ? stats.allocated_bytes : 0;
+  };
+
+  // lazily created engine internals (interned strings, property hashmaps, ...) are not leaks
+  bool ok = run(iterations < 1000 ? iterations : 1000);
+  const size_t before = heap();
+
+  ok = ok && run(iterations);
+  const size_t after = heap();
+
+  jerry_release_value(script);
+
+  if (!ok)
+    return false;
+
+  if (!jerry_is_feature_enabled(JERRY_FEATURE_MEM_STATS))
+  {
+    fprintf(stderr, "rtjs soak: '%s' ran %lu times (no heap stats, engine built without JERRY_MEM_STATS)\n", source.c_str(), iterations);
+    return true;
+  }
+
+  if (after > before + toleranceBytes)
+  {
+    fprintf(stderr, "rtjs soak: '%s' grew the heap from %zu to %zu bytes in %lu iterations\n", source.c_str(), before, after, iterations);
+    return false;
+  }
+
+  fprintf(stderr, "rtjs soak: '%s' ran %lu times, heap %zu -> %zu bytes\n", source.c_str(), iterations, before, after);
+  return true;
+}
+
+
+}
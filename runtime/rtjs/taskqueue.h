@@ -0,0 +1,194 @@
+#pragma once
+
+#include <jerryscript.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+
+namespace rtjs
+{
+
+
+// bounded lock-free queue, any number of threads push, one thread pops.
+// every cell carries a sequence number telling whether it is free for the push at position n
+// (sequence == n) or holds the value of that push (sequence == n + 1)
+template<typename T>
+class MpscQueue
+{
+public:
+  // capacity gets rounded up to a power of two
+  explicit MpscQueue(size_t capacity)
+  {
+    size_t size = 2;
+    while (size < capacity)
+      size *= 2;
+
+    mMask = size - 1;
+    mCells.reset(new Cell[size]);
+    for (size_t i = 0; i < size; i++)
+      mCells[i].mSequence.store(i, std::memory_order_relaxed);
+  }
+
+  MpscQueue(const MpscQueue &) = delete;
+  MpscQueue &operator=(const MpscQueue &) = delete;
+
+  // any thread, false if the queue is full (value is left untouched then)
+  bool push(T &&value)
+  {
+    size_t pos = mTail.load(std::memory_order_relaxed);
+    Cell *cell;
+    while (true)
+    {
+      cell = &mCells[pos & mMask];
+      const size_t sequence = cell->mSequence.load(std::memory_order_acquire);
+      const intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+
+      if (diff == 0 && mTail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        break;
+      if (diff < 0) // the consumer is a whole round behind
+        return false;
+      if (diff > 0) // another producer took pos
+        pos = mTail.load(std::memory_order_relaxed);
+    }
+
+    cell->mValue = std::move(value);
+    cell->mSequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // consumer thread only
+  bool pop(T &value)
+  {
+    Cell *cell = &mCells[mHead & mMask];
+    if (cell->mSequence.load(std::memory_order_acquire) != mHead + 1)
+      return false; // empty, or the push there has not finished yet
+
+    value = std::move(cell->mValue);
+    cell->mValue = T();
+    cell->mSequence.store(mHead + mMask + 1, std::memory_order_release); // free for the next round
+    mHead++;
+    return true;
+  }
+
+  size_t capacity() const
+  {
+    return mMask + 1;
+  }
+
+private:
+  struct Cell
+  {
+    std::atomic<size_t> mSequence;
+    T mValue;
+  };
+
+  std::unique_ptr<Cell[]> mCells;
+  size_t mMask;
+  alignas(64) std::atomic<size_t> mTail { 0 }; // producers
+  alignas(64) size_t mHead = 0; // consumer
+};
+
+
+// hands work from native threads to the js thread of one context without locking the engine:
+// producers post() closures (capturing whatever payload they carry), the js thread runs them in
+// batches with drain() whenever notifyFd() becomes readable (EventLoop::attachTaskQueue())
+class TaskQueue
+{
+public:
+  typedef std::function<void()> Task;
+
+  explicit TaskQueue(size_t capacity = 4096)
+    : mQueue(capacity)
+    , mNotifyFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+  {
+  }
+
+  ~TaskQueue()
+  {
+    close(mNotifyFd);
+  }
+
+  TaskQueue(const TaskQueue &) = delete;
+  TaskQueue &operator=(const TaskQueue &) = delete;
+
+  // any thread, false if the queue is full
+  bool post(Task task)
+  {
+    if (!mQueue.push(std::move(task)))
+      return false;
+
+    // one wakeup per batch: only the first post after a drain() touches the eventfd
+    if (!mSignalled.exchange(true, std::memory_order_acq_rel))
+    {
+      const uint64_t one = 1;
+      ssize_t written = write(mNotifyFd, &one, sizeof(one));
+      (void)written;
+    }
+    return true;
+  }
+
+  // any thread, waits for the js thread to make room if the queue is full
+  void postWaiting(Task task)
+  {
+    while (!post(task))
+      std::this_thread::yield();
+  }
+
+  // js thread, runs up to maxTasks tasks (0: all there are) and then the job queue once,
+  // returns the number of tasks run
+  size_t drain(size_t maxTasks = 0)
+  {
+    uint64_t count;
+    ssize_t readBytes = read(mNotifyFd, &count, sizeof(count)); // just resets the counter
+    (void)readBytes;
+
+    // before popping, so that a post() racing with the last pop signals again
+    mSignalled.exchange(false, std::memory_order_acq_rel);
+
+    size_t ran = 0;
+    Task task;
+    while ((maxTasks == 0 || ran < maxTasks) && mQueue.pop(task))
+    {
+      task();
+      ran++;
+    }
+
+    if (maxTasks != 0 && ran == maxTasks) // more left, keep the fd readable
+      signal();
+
+    if (ran > 0) // promise reactions
+      jerry_release_value(jerry_run_all_enqueued_jobs());
+
+    return ran;
+  }
+
+  int notifyFd() const
+  {
+    return mNotifyFd;
+  }
+
+private:
+  void signal()
+  {
+    mSignalled.store(true, std::memory_order_release);
+
+    const uint64_t one = 1;
+    ssize_t written = write(mNotifyFd, &one, sizeof(one));
+    (void)written;
+  }
+
+  MpscQueue<Task> mQueue;
+  std::atomic<bool> mSignalled { false };
+  int mNotifyFd;
+};
+
+
+}
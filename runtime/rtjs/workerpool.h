@@ -0,0 +1,200 @@
+#pragma once
+
+#include <jerryscript.h>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+
+namespace rtjs
+{
+
+
+// result of a call made on the worker pool, read back on the js thread
+template<typename T>
+class AsyncResult
+{
+public:
+  template<typename F>
+  void run(F call)
+  {
+    try
+    {
+      mValue = call();
+    }
+    catch (const std::string &msg)
+    {
+      mFailed = true;
+      mError = msg;
+    }
+    catch (const std::exception &e)
+    {
+      mFailed = true;
+      mError = e.what();
+    }
+  }
+
+  T mValue = T();
+  bool mFailed = false;
+  std::string mError;
+};
+
+
+template<>
+class AsyncResult<void>
+{
+public:
+  template<typename F>
+  void run(F call)
+  {
+    try
+    {
+      call();
+    }
+    catch (const std::string &msg)
+    {
+      mFailed = true;
+      mError = msg;
+    }
+    catch (const std::exception &e)
+    {
+      mFailed = true;
+      mError = e.what();
+    }
+  }
+
+  bool mFailed = false;
+  std::string mError;
+};
+
+
+// runs blocking native calls off the js thread.
+// the completions are queued and must be run on the js thread with runCompletions(),
+// notifyFd() becomes readable whenever there is something to run.
+class WorkerPool
+{
+public:
+  static WorkerPool &instance()
+  {
+    static WorkerPool pool;
+    return pool;
+  }
+
+  void post(std::function<void()> work, std::function<void()> completion)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mWork.push_back({ std::move(work), std::move(completion) });
+    }
+    mWorkAvailable.notify_one();
+  }
+
+  // returns the number of completions run
+  int runCompletions()
+  {
+    uint64_t count;
+    ssize_t readBytes = read(mNotifyFd, &count, sizeof(count)); // just resets the counter, EAGAIN if nothing was signalled
+    (void)readBytes;
+
+    std::deque<std::function<void()>> completions;
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      completions.swap(mCompletions);
+    }
+
+    for (const auto &completion : completions)
+      completion();
+
+    if (!completions.empty()) // promise reactions
+      jerry_release_value(jerry_run_all_enqueued_jobs());
+
+    return (int)completions.size();
+  }
+
+  int notifyFd() const
+  {
+    return mNotifyFd;
+  }
+
+private:
+  struct Task
+  {
+    std::function<void()> mWork;
+    std::function<void()> mCompletion;
+  };
+
+  WorkerPool()
+    : mNotifyFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+  {
+    unsigned int threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0)
+      threadCount = 2;
+
+    for (unsigned int i = 0; i < threadCount; i++)
+      mThreads.emplace_back(&WorkerPool::worker, this);
+  }
+
+  ~WorkerPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mQuit = true;
+    }
+    mWorkAvailable.notify_all();
+
+    for (std::thread &thread : mThreads)
+      thread.join();
+
+    close(mNotifyFd);
+  }
+
+  void worker()
+  {
+    while (true)
+    {
+      Task task;
+      {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mWorkAvailable.wait(lock, [this]() { return mQuit || !mWork.empty(); });
+
+        if (mQuit)
+          return;
+
+        task = std::move(mWork.front());
+        mWork.pop_front();
+      }
+
+      task.mWork();
+
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCompletions.push_back(std::move(task.mCompletion));
+      }
+
+      const uint64_t one = 1;
+      ssize_t written = write(mNotifyFd, &one, sizeof(one)); // can only fail on counter overflow, when the js thread gets woken anyway
+      (void)written;
+    }
+  }
+
+  std::mutex mMutex;
+  std::condition_variable mWorkAvailable;
+  std::deque<Task> mWork;
+  std::deque<std::function<void()>> mCompletions;
+  std::vector<std::thread> mThreads;
+  bool mQuit = false;
+  int mNotifyFd;
+};
+
+
+}
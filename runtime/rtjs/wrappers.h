@@ -0,0 +1,209 @@
+#pragma once
+
+#include <jerryscript.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+
+namespace rtjs
+{
+
+
+// wrapper objects by (native pointer, native info), so returning the same pointer again gives scripts
+// the same object instead of a new one per call. the wrappers are held weakly: the map doesn't acquire
+// them, the free callback of the native info has to remove() the entry when the engine collects one.
+// open addressing with linear probing, deletion shifts the following entries back (no tombstones).
+// an entry may also own the object (smart pointers handed to scripts): a deleter for sole ownership or a
+// shared_ptr, released by remove(). no allocation per wrapper, the ownership lives in the slot
+class WrapperMap
+{
+public:
+  // one per process, the generated bindings run a single engine context
+  static WrapperMap &instance()
+  {
+    static WrapperMap map;
+    return map;
+  }
+
+  // the live wrapper of ptr with tag, not acquired
+  bool find(const void *ptr, const jerry_object_native_info_t *tag, jerry_value_t &wrapper) const
+  {
+    if (mCount == 0)
+      return false;
+
+    for (size_t i = slot(ptr, tag); mSlots[i].mPtr; i = (i + 1) & mMask)
+    {
+      if (mSlots[i].mPtr == ptr && mSlots[i].mTag == tag)
+      {
+        wrapper = mSlots[i].mWrapper;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void insert(const void *ptr, const jerry_object_native_info_t *tag, const jerry_value_t wrapper)
+  {
+    if ((mCount + 1) * 2 > mSlots.size()) // at most half full, keeps the probe sequences short
+      rehash(mSlots.empty() ? 64 : mSlots.size() * 2);
+
+    size_t i = slot(ptr, tag);
+    while (mSlots[i].mPtr && !(mSlots[i].mPtr == ptr && mSlots[i].mTag == tag))
+      i = (i + 1) & mMask;
+
+    if (!mSlots[i].mPtr)
+      mCount++;
+    mSlots[i].mPtr = ptr; // an owner of the entry stays
+    mSlots[i].mTag = tag;
+    mSlots[i].mWrapper = wrapper;
+  }
+
+  // sole ownership of the object for the entry of a live wrapper, false if it has an owner already
+  bool own(const void *ptr, const jerry_object_native_info_t *tag, void (*deleter)(void *))
+  {
+    Slot *slot = lookup(ptr, tag);
+    if (!slot || slot->mDelete || slot->mShared)
+      return false;
+
+    slot->mDelete = deleter;
+    return true;
+  }
+
+  // shared ownership, same
+  bool share(const void *ptr, const jerry_object_native_info_t *tag, std::shared_ptr<void> owner)
+  {
+    Slot *slot = lookup(ptr, tag);
+    if (!slot || slot->mDelete || slot->mShared)
+      return false;
+
+    slot->mShared = std::move(owner);
+    return true;
+  }
+
+  // the owner of the object, empty if the entry doesn't own it. sole ownership turns into shared
+  // ownership here, the only time a control block gets allocated
+  std::shared_ptr<void> shared(const void *ptr, const jerry_object_native_info_t *tag)
+  {
+    Slot *slot = lookup(ptr, tag);
+    if (!slot)
+      return std::shared_ptr<void>();
+
+    if (slot->mDelete)
+    {
+      slot->mShared = std::shared_ptr<void>(const_cast<void *>(ptr), slot->mDelete);
+      slot->mDelete = nullptr;
+    }
+    return slot->mShared;
+  }
+
+  // gives up sole ownership without deleting, false if the entry doesn't have it
+  bool release(const void *ptr, const jerry_object_native_info_t *tag)
+  {
+    Slot *slot = lookup(ptr, tag);
+    if (!slot || !slot->mDelete)
+      return false;
+
+    slot->mDelete = nullptr;
+    return true;
+  }
+
+  void remove(const void *ptr, const jerry_object_native_info_t *tag)
+  {
+    if (mCount == 0)
+      return;
+
+    size_t i = slot(ptr, tag);
+    while (!(mSlots[i].mPtr == ptr && mSlots[i].mTag == tag))
+    {
+      if (!mSlots[i].mPtr)
+        return;
+      i = (i + 1) & mMask;
+    }
+
+    Slot removed(std::move(mSlots[i]));
+
+    // moves every following entry of the cluster that may live in the hole
+    for (size_t j = (i + 1) & mMask; mSlots[j].mPtr; j = (j + 1) & mMask)
+    {
+      const size_t home = slot(mSlots[j].mPtr, mSlots[j].mTag);
+      if (((j - home) & mMask) >= ((j - i) & mMask))
+      {
+        mSlots[i] = std::move(mSlots[j]);
+        i = j;
+      }
+    }
+
+    mSlots[i] = Slot();
+    mCount--;
+
+    // last, the destructor of the object may release other wrapped objects
+    if (removed.mDelete)
+      removed.mDelete(const_cast<void *>(removed.mPtr));
+  }
+
+  size_t size() const
+  {
+    return mCount;
+  }
+
+private:
+  struct Slot
+  {
+    const void *mPtr; // nullptr: empty
+    const jerry_object_native_info_t *mTag;
+    jerry_value_t mWrapper;
+    void (*mDelete)(void *); // sole owner
+    std::shared_ptr<void> mShared; // shared owner
+  };
+
+  Slot *lookup(const void *ptr, const jerry_object_native_info_t *tag)
+  {
+    if (mCount == 0)
+      return nullptr;
+
+    for (size_t i = slot(ptr, tag); mSlots[i].mPtr; i = (i + 1) & mMask)
+    {
+      if (mSlots[i].mPtr == ptr && mSlots[i].mTag == tag)
+        return &mSlots[i];
+    }
+    return nullptr;
+  }
+
+  size_t slot(const void *ptr, const jerry_object_native_info_t *tag) const
+  {
+    uint64_t hash = (uint64_t)(uintptr_t)ptr ^ ((uint64_t)(uintptr_t)tag << 7);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return (size_t)hash & mMask;
+  }
+
+  void rehash(size_t capacity)
+  {
+    std::vector<Slot> old(capacity);
+    old.swap(mSlots);
+    mMask = capacity - 1;
+
+    for (Slot &entry : old)
+    {
+      if (!entry.mPtr)
+        continue;
+
+      size_t i = slot(entry.mPtr, entry.mTag);
+      while (mSlots[i].mPtr)
+        i = (i + 1) & mMask;
+      mSlots[i] = std::move(entry);
+    }
+  }
+
+  std::vector<Slot> mSlots;
+  size_t mMask = 0;
+  size_t mCount = 0;
+};
+
+
+}
@@ -0,0 +1,24 @@
+  // runs on the worker pool, the promise gets settled on the js thread by rtjs::WorkerPool::runCompletions()
+  jerry_value_t promise = jerry_create_promise();
+  jerry_value_t pending = jerry_acquire_value(promise);
+  auto result = std::make_shared<rtjs::AsyncResult<decltype(%1(%2))>>();
+  const std::vector<jerry_value_t> wrappers = { %4 }; // keeps the objects of the arguments alive
+
+  rtjs::WorkerPool::instance().post([=]()
+  {
+    result->run([=]() { return %1(%2); });
+  },
+  [=]()
+  {
+    RTJS_AUDIT_TASK("%1");
+    jerry_value_t value = result->mFailed
+        ? jerry_get_value_from_error(jerry_create_error(JERRY_ERROR_COMMON, (const jerry_char_t *)result->mError.c_str()), true)
+        : %3;
+    jerry_release_value(jerry_resolve_or_reject_promise(pending, value, !result->mFailed));
+    jerry_release_value(value);
+    jerry_release_value(pending);
+    for (jerry_value_t wrapper : wrappers)
+      jerry_release_value(wrapper);
+  });
+
+  return promise;
@@ -0,0 +1,98 @@
+// class %1
+static jerry_value_t _rtjs_%4_proto; // fields and member functions, shared with the classes derived from %1
+
+// deletes the object if the wrapper owned it (see _rtjs_adopt_%4_object() and _rtjs_share_%4_object()),
+// otherwise it stays owned by native code and only the wrapper is gone
+static void _rtjs_%4_free(void *ptr)
+{
+  rtjs::WrapperMap::instance().remove(ptr, &_rtjs_%4_info);
+}
+
+static void _rtjs_%4_delete(void *ptr)
+{
+  delete static_cast<%1 *>(ptr);
+}
+
+// the %1 behind value, also if it wraps an object of a derived class, nullptr for anything else
+static inline %1 *_rtjs_%4_native(const jerry_value_t value)
+{
+  return static_cast<%1 *>(rtjs::nativeAs(value, _rtjs_%4_upcasts, sizeof(_rtjs_%4_upcasts) / sizeof(_rtjs_%4_upcasts[0])));
+}
+
+static inline %1 *_rtjs_%4_this(const jerry_value_t this_val)
+{
+  %1 *ptr = _rtjs_%4_native(this_val);
+  if (!ptr)
+    throw std::string("%1 member called on something else than a %1");
+  return ptr;
+}
+
+// the wrapper of class_ptr, one per pointer while alive
+jerry_value_t _rtjs_create_%4_object(%1 *class_ptr)
+{
+  if (!class_ptr)
+    return jerry_create_null();
+
+  jerry_value_t obj;
+  if (_rtjs_find_wrapper((void *)class_ptr, &_rtjs_%4_info, obj))
+    return obj;
+
+  obj = _rtjs_new_wrapper((void *)class_ptr, &_rtjs_%4_info);
+  jerry_release_value(jerry_set_prototype(obj, _rtjs_%4_proto));
+  return obj;
+}
+
+// the wrapper of an object handed over to scripts, deleted along with the wrapper
+jerry_value_t _rtjs_adopt_%4_object(std::unique_ptr<%1> object)
+{
+  %1 *ptr = object.release();
+  jerry_value_t obj = _rtjs_create_%4_object(ptr);
+  rtjs::WrapperMap::instance().own(ptr, &_rtjs_%4_info, _rtjs_%4_delete); // unless it has an owner already
+  return obj;
+}
+
+// the wrapper of a shared object, which it keeps alive
+jerry_value_t _rtjs_share_%4_object(const std::shared_ptr<%1> &object)
+{
+  jerry_value_t obj = _rtjs_create_%4_object(object.get());
+  rtjs::WrapperMap::instance().share(object.get(), &_rtjs_%4_info, object);
+  return obj;
+}
+
+// the object behind value for a shared_ptr parameter: shares the ownership of the wrapper (aliasing
+// constructor, just a reference count increment)
+static inline std::shared_ptr<%1> _rtjs_%4_shared(const jerry_value_t value)
+{
+  void *ptr = nullptr;
+  const rtjs::Upcast *upcast = rtjs::findUpcast(value, _rtjs_%4_upcasts, sizeof(_rtjs_%4_upcasts) / sizeof(_rtjs_%4_upcasts[0]), ptr);
+  if (!upcast)
+    throw std::string("%1 expected");
+
+  std::shared_ptr<void> owner(rtjs::WrapperMap::instance().shared(ptr, upcast->mInfo));
+  if (!owner)
+    throw std::string("%1 not owned by scripts or a shared_ptr, cannot be shared");
+  return std::shared_ptr<%1>(owner, reinterpret_cast<%1 *>(static_cast<char *>(ptr) + upcast->mOffset));
+}
+
+// the object behind value for a unique_ptr parameter: the wrapper gives up its ownership and gets detached,
+// using it later throws
+static inline std::unique_ptr<%1> _rtjs_%4_release(const jerry_value_t value)
+{
+  void *ptr = nullptr;
+  const rtjs::Upcast *upcast = rtjs::findUpcast(value, _rtjs_%4_upcasts, sizeof(_rtjs_%4_upcasts) / sizeof(_rtjs_%4_upcasts[0]), ptr);
+  if (!upcast)
+    throw std::string("%1 expected");
+
+  // the unique_ptr deletes through a %1 *, for a derived object only fine with a virtual destructor
+  if (!%3 && upcast->mInfo != &_rtjs_%4_info)
+    throw std::string("%1 wraps an object of a derived class, cannot be handed over");
+
+  if (!rtjs::WrapperMap::instance().release(ptr, upcast->mInfo))
+    throw std::string("%1 not owned by scripts alone, cannot be handed over");
+
+  jerry_delete_object_native_pointer(value, upcast->mInfo);
+  rtjs::WrapperMap::instance().remove(ptr, upcast->mInfo);
+  return std::unique_ptr<%1>(reinterpret_cast<%1 *>(static_cast<char *>(ptr) + upcast->mOffset));
+}
+
+%2
@@ -0,0 +1,29 @@
+// %1
+static jerry_value_t _rtjs_%2_to_js(const %1 &value)
+{
+  jerry_value_t array = jerry_create_array((uint32_t)value.size());
+  for (uint32_t i = 0; i < (uint32_t)value.size(); i++)
+  {
+    jerry_value_t element = %3;
+    jerry_release_value(jerry_set_property_by_index(array, i, element));
+    jerry_release_value(element);
+  }
+  return array;
+}
+
+static %1 _rtjs_%2_from_js(const jerry_value_t value)
+{
+  if (!jerry_value_is_array(value))
+    throw std::string("array expected for %1");
+
+  const uint32_t length = jerry_get_array_length(value);
+  %1 result%4;
+  for (uint32_t i = 0; i < length && i < (uint32_t)result.size(); i++)
+  {
+    jerry_value_t element = jerry_get_property_by_index(value, i);
+    result[i] = %5;
+    jerry_release_value(element);
+  }
+  return result;
+}
+
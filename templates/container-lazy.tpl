@@ -0,0 +1,11 @@
+// %1 as iterable
+struct _rtjs_%2_elements
+{
+  static jerry_value_t toJs(const %1::value_type &element)
+  {
+%3
+  }
+};
+
+typedef rtjs::Iterable<%1, _rtjs_%2_elements> _rtjs_%2_iterable;
+
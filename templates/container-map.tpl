@@ -0,0 +1,33 @@
+// %1
+static jerry_value_t _rtjs_%2_to_js(const %1 &value)
+{
+  jerry_value_t obj = jerry_create_object();
+  for (const auto &entry : value)
+  {
+    jerry_value_t element = %3;
+%4
+    jerry_release_value(element);
+  }
+  return obj;
+}
+
+static %1 _rtjs_%2_from_js(const jerry_value_t value)
+{
+  if (!jerry_value_is_object(value))
+    throw std::string("object expected for %1");
+
+  %1 result;
+  jerry_value_t keys = jerry_get_object_keys(value);
+  const uint32_t length = jerry_get_array_length(keys);
+  for (uint32_t i = 0; i < length; i++)
+  {
+    jerry_value_t key = jerry_get_property_by_index(keys, i);
+    jerry_value_t element = jerry_get_property(value, key);
+    result.emplace(%5, %6);
+    jerry_release_value(element);
+    jerry_release_value(key);
+  }
+  jerry_release_value(keys);
+  return result;
+}
+
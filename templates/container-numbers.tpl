@@ -0,0 +1,13 @@
+// %1
+static jerry_value_t _rtjs_%2_to_js(const %1 &value)
+{
+  return _rtjs_typedarray_from(value.data(), value.size());
+}
+
+static %1 _rtjs_%2_from_js(const jerry_value_t value)
+{
+  %1 result%3;
+  _rtjs_numbers_from_js(value, result.data(), %4);
+  return result;
+}
+
@@ -0,0 +1,130 @@
+// containers
+
+
+// typed array kind per element type, types without one of their own go through a Float64Array
+template<typename T> struct _rtjs_typedarray_kind { static const jerry_typedarray_type_t type = JERRY_TYPEDARRAY_FLOAT64; static const bool exact = false; };
+template<> struct _rtjs_typedarray_kind<double> { static const jerry_typedarray_type_t type = JERRY_TYPEDARRAY_FLOAT64; static const bool exact = true; };
+template<> struct _rtjs_typedarray_kind<float> { static const jerry_typedarray_type_t type = JERRY_TYPEDARRAY_FLOAT32; static const bool exact = true; };
+template<> struct _rtjs_typedarray_kind<int8_t> { static const jerry_typedarray_type_t type = JERRY_TYPEDARRAY_INT8; static const bool exact = true; };
+template<> struct _rtjs_typedarray_kind<uint8_t> { static const jerry_typedarray_type_t type = JERRY_TYPEDARRAY_UINT8; static const bool exact = true; };
+template<> struct _rtjs_typedarray_kind<int16_t> { static const jerry_typedarray_type_t type = JERRY_TYPEDARRAY_INT16; static const bool exact = true; };
+template<> struct _rtjs_typedarray_kind<uint16_t> { static const jerry_typedarray_type_t type = JERRY_TYPEDARRAY_UINT16; static const bool exact = true; };
+template<> struct _rtjs_typedarray_kind<int32_t> { static const jerry_typedarray_type_t type = JERRY_TYPEDARRAY_INT32; static const bool exact = true; };
+template<> struct _rtjs_typedarray_kind<uint32_t> { static const jerry_typedarray_type_t type = JERRY_TYPEDARRAY_UINT32; static const bool exact = true; };
+
+
+// element type conversion: plain loops over restrict pointers, which the compiler vectorises at -O2/-O3
+template<typename S, typename D>
+static inline void _rtjs_convert(const S *__restrict src, D *__restrict dst, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+    dst[i] = (D)src[i];
+}
+
+
+template<typename T>
+static inline void _rtjs_convert(const T *src, T *dst, size_t count)
+{
+  memcpy(dst, src, count * sizeof(T));
+}
+
+
+static inline jerry_length_t _rtjs_length(const jerry_value_t value)
+{
+  if (jerry_value_is_typedarray(value))
+    return jerry_get_typedarray_length(value);
+
+  if (jerry_value_is_array(value))
+    return jerry_get_array_length(value);
+
+  throw std::string("array or typed array expected");
+}
+
+
+static inline double _rtjs_key_to_number(const jerry_value_t key)
+{
+  jerry_value_t number = jerry_value_to_number(key);
+  double result = jerry_get_number_value(number);
+  jerry_release_value(number);
+  return result;
+}
+
+
+// numeric map keys as property names: indices for unsigned keys of up to 32 bits, the number as string
+// for all others, so that -1 doesn't turn into "4294967295" and 1.5 doesn't merge with 1
+template<typename K>
+static inline void _rtjs_set_number_key(const jerry_value_t obj, const K key, const jerry_value_t element)
+{
+  if (std::is_unsigned<K>::value && sizeof(K) <= sizeof(uint32_t))
+  {
+    jerry_release_value(jerry_set_property_by_index(obj, (uint32_t)key, element));
+    return;
+  }
+
+  jerry_value_t number = jerry_create_number((double)key);
+  jerry_value_t name = jerry_value_to_string(number);
+  jerry_release_value(jerry_set_property(obj, name, element));
+  jerry_release_value(name);
+  jerry_release_value(number);
+}
+
+
+// numbers to a preallocated typed array, a single memcpy if the element type has a typed array of its own
+template<typename T>
+static jerry_value_t _rtjs_typedarray_from(const T *data, size_t count)
+{
+  typedef _rtjs_typedarray_kind<T> kind;
+
+  jerry_value_t array = jerry_create_typedarray(kind::type, (jerry_length_t)count);
+  jerry_length_t offset = 0;
+  jerry_length_t length = 0;
+  jerry_value_t buffer = jerry_get_typedarray_buffer(array, &offset, &length);
+  uint8_t *dst = jerry_get_arraybuffer_pointer(buffer) + offset;
+
+  if (kind::exact)
+    memcpy(dst, data, count * sizeof(T));
+  else
+    _rtjs_convert(data, (double *)dst, count);
+
+  jerry_release_value(buffer);
+  return array;
+}
+
+
+// numbers from a typed array of any kind (bulk conversion) or a plain array (per element)
+template<typename T>
+static void _rtjs_numbers_from_js(const jerry_value_t value, T *out, size_t count)
+{
+  if (jerry_value_is_typedarray(value))
+  {
+    jerry_length_t offset = 0;
+    jerry_length_t length = 0;
+    jerry_value_t buffer = jerry_get_typedarray_buffer(value, &offset, &length);
+    const uint8_t *src = jerry_get_arraybuffer_pointer(buffer) + offset;
+
+    switch (jerry_get_typedarray_type(value))
+    {
+      case JERRY_TYPEDARRAY_INT8: _rtjs_convert((const int8_t *)src, out, count); break;
+      case JERRY_TYPEDARRAY_UINT8:
+      case JERRY_TYPEDARRAY_UINT8CLAMPED: _rtjs_convert((const uint8_t *)src, out, count); break;
+      case JERRY_TYPEDARRAY_INT16: _rtjs_convert((const int16_t *)src, out, count); break;
+      case JERRY_TYPEDARRAY_UINT16: _rtjs_convert((const uint16_t *)src, out, count); break;
+      case JERRY_TYPEDARRAY_INT32: _rtjs_convert((const int32_t *)src, out, count); break;
+      case JERRY_TYPEDARRAY_UINT32: _rtjs_convert((const uint32_t *)src, out, count); break;
+      case JERRY_TYPEDARRAY_FLOAT32: _rtjs_convert((const float *)src, out, count); break;
+      case JERRY_TYPEDARRAY_FLOAT64: _rtjs_convert((const double *)src, out, count); break;
+      default: break;
+    }
+
+    jerry_release_value(buffer);
+    return;
+  }
+
+  for (size_t i = 0; i < count; i++)
+  {
+    jerry_value_t element = jerry_get_property_by_index(value, (uint32_t)i);
+    out[i] = (T)jerry_get_number_value(element);
+    jerry_release_value(element);
+  }
+}
+
@@ -0,0 +1,53 @@
+// enum %1
+static const struct
+{
+  const char *name;
+  jerry_size_t length;
+  %1 value;
+} _rtjs_%2_slots[%3] =
+{
+%4};
+
+static const %1 _rtjs_%2_values[] = { %10 };
+
+static jerry_value_t _rtjs_%2_names[%5];
+
+static %1 _rtjs_%2_from_js(const jerry_value_t value)
+{
+  if (jerry_value_is_number(value))
+  {
+    // only the numbers of enumerators, no out of range values in native code
+    const double number = jerry_get_number_value(value);
+    for (const %1 enumerator : _rtjs_%2_values)
+    {
+      if ((double)(long long)enumerator == number)
+        return enumerator;
+    }
+
+    throw std::string("invalid enumerator number for enum %1");
+  }
+
+  if (!jerry_value_is_string(value))
+    throw std::string("enum %1 must be passed as number or string");
+
+  // names longer than the longest enumerator can't match, so no allocation is ever needed
+  jerry_char_t buffer[%6];
+  jerry_size_t length = jerry_get_utf8_string_size(value);
+  if (length <= sizeof(buffer))
+  {
+    jerry_string_to_utf8_char_buffer(value, buffer, length);
+
+    const auto &slot = _rtjs_%2_slots[_rtjs_hash(buffer, length, %7u) & %8];
+    if (slot.length == length && memcmp(slot.name, buffer, length) == 0)
+      return slot.value;
+  }
+
+  throw std::string("invalid enumerator name for enum %1");
+}
+
+static jerry_value_t _rtjs_%2_to_js(const %1 value)
+{
+%9
+  return jerry_create_number((double)(long long)value);
+}
+
@@ -0,0 +1,10 @@
+static jerry_value_t %1_get(
+  const jerry_value_t function_obj,
+  const jerry_value_t this_val,
+  const jerry_value_t args[],
+  const jerry_length_t argc)
+{
+  RTJS_AUDIT_SCOPE("%1_get");
+  return %2;
+}
+
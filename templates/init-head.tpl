@@ -1,3 +1,17 @@
 #include <jerryscript.h>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include <rtjs/budget.h>
+#include <rtjs/callbacks.h>
+#include <rtjs/classes.h>
+#include <rtjs/wrappers.h>
 
@@ -0,0 +1,185 @@
+// per binding reference accounting with rtjsgen --audit, see rtjs/audit.h
+#ifndef RTJS_AUDIT_SCOPE
+#define RTJS_AUDIT_SCOPE(name)
+#define RTJS_AUDIT_TASK(name)
+#define RTJS_AUDIT_CREATED(value) (value)
+#endif
+
+
+// FNV-1a with a seed, must match hashName() in rtjsgen
+static inline uint32_t _rtjs_hash(const jerry_char_t *str, jerry_size_t length, uint32_t seed)
+{
+  uint32_t hash = 2166136261u ^ seed;
+  for (jerry_size_t i = 0; i < length; i++)
+  {
+    hash ^= str[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+
+static inline void _rtjs_define_accessor(const jerry_value_t obj, const jerry_value_t name,
+                                         jerry_external_handler_t getter, jerry_external_handler_t setter)
+{
+  jerry_property_descriptor_t desc;
+  jerry_init_property_descriptor_fields(&desc);
+
+  desc.is_get_defined = true;
+  desc.getter = jerry_create_external_function(getter);
+
+  if (setter) // read-only otherwise
+  {
+    desc.is_set_defined = true;
+    desc.setter = jerry_create_external_function(setter);
+  }
+
+  desc.is_enumerable_defined = true;
+  desc.is_enumerable = true;
+
+  jerry_release_value(jerry_define_own_property(obj, name, &desc));
+  jerry_free_property_descriptor_fields(&desc);
+}
+
+
+static inline void _rtjs_set_number(const jerry_value_t obj, const char *name, double number)
+{
+  jerry_value_t prop_name = jerry_create_string((const jerry_char_t *)name);
+  jerry_value_t value = jerry_create_number(number);
+  jerry_release_value(jerry_set_property(obj, prop_name, value));
+  jerry_release_value(prop_name);
+  jerry_release_value(value);
+}
+
+
+// for the errors of handlers generated with --validation debug
+static inline const char *_rtjs_type_name(const jerry_value_t value)
+{
+  switch (jerry_value_get_type(value))
+  {
+    case JERRY_TYPE_UNDEFINED: return "undefined";
+    case JERRY_TYPE_NULL: return "null";
+    case JERRY_TYPE_BOOLEAN: return "a boolean";
+    case JERRY_TYPE_NUMBER: return "a number";
+    case JERRY_TYPE_STRING: return "a string";
+    case JERRY_TYPE_OBJECT: return "an object";
+    case JERRY_TYPE_FUNCTION: return "a function";
+    case JERRY_TYPE_SYMBOL: return "a symbol";
+    default: return "something else";
+  }
+}
+
+
+// whether the number in value converts to T without losing anything
+template<typename T>
+static inline bool _rtjs_number_fits(const jerry_value_t value)
+{
+  const double number = jerry_get_number_value(value);
+  if (!std::is_integral<T>::value)
+    return true;
+
+  return std::trunc(number) == number
+      && number >= (double)std::numeric_limits<T>::lowest()
+      && number < (double)std::numeric_limits<T>::max() + 1.0;
+}
+
+
+// the wrapper scripts already hold for ptr (acquired), see rtjs/wrappers.h
+static inline bool _rtjs_find_wrapper(void *ptr, const jerry_object_native_info_t *info, jerry_value_t &obj)
+{
+  if (!rtjs::WrapperMap::instance().find(ptr, info, obj))
+    return false;
+
+  obj = jerry_acquire_value(obj);
+  return true;
+}
+
+
+// new wrapper for ptr, the free callback of info has to remove it from rtjs::WrapperMap again
+static inline jerry_value_t _rtjs_new_wrapper(void *ptr, const jerry_object_native_info_t *info)
+{
+  jerry_value_t obj = jerry_create_object();
+  jerry_set_object_native_pointer(obj, ptr, info);
+  rtjs::WrapperMap::instance().insert(ptr, info, obj);
+  return obj;
+}
+
+
+static void _rtjs_pointer_free(void *ptr);
+static const jerry_object_native_info_t _rtjs_pointer_info = { _rtjs_pointer_free };
+
+static void _rtjs_pointer_free(void *ptr)
+{
+  rtjs::WrapperMap::instance().remove(ptr, &_rtjs_pointer_info);
+}
+
+
+// object with the raw pointer in it, the same one as long as it is alive
+static inline jerry_value_t _rtjs_pointer_to_js(void *ptr)
+{
+  if (!ptr)
+    return jerry_create_null();
+
+  jerry_value_t obj;
+  if (_rtjs_find_wrapper(ptr, &_rtjs_pointer_info, obj))
+    return obj;
+  return _rtjs_new_wrapper(ptr, &_rtjs_pointer_info);
+}
+
+
+static inline std::string _rtjs_string_from_js(const jerry_value_t value)
+{
+  if (!jerry_value_is_string(value))
+    throw std::string("string expected");
+
+  std::string result(jerry_get_utf8_string_size(value), '\0');
+  jerry_string_to_utf8_char_buffer(value, (jerry_char_t *)&result[0], (jerry_size_t)result.size());
+  return result;
+}
+
+
+static inline jerry_value_t _rtjs_string_to_js(const std::string &value)
+{
+  return jerry_create_string_sz_from_utf8((const jerry_char_t *)value.data(), (jerry_size_t)value.size());
+}
+
+static inline jerry_value_t _rtjs_string_to_js(const char *value)
+{
+  if (!value)
+    return jerry_create_null();
+  return jerry_create_string_from_utf8((const jerry_char_t *)value);
+}
+
+// std::string_view, without needing c++17 here
+template<typename View>
+static inline jerry_value_t _rtjs_string_to_js(const View &value)
+{
+  return jerry_create_string_sz_from_utf8((const jerry_char_t *)value.data(), (jerry_size_t)value.size());
+}
+
+
+static void _rtjs_owned_string_free(void *ptr)
+{
+  free(ptr);
+}
+
+// the engine references the native text instead of copying it, owned: malloc'ed, freed by the engine
+// together with the string. external strings are cesu-8, which is utf-8 without 4 byte sequences
+static inline jerry_value_t _rtjs_external_string_to_js(const char *value, size_t size, bool owned)
+{
+  if (!value)
+    return jerry_create_null();
+  return jerry_create_external_string_sz((const jerry_char_t *)value, (jerry_size_t)size, owned ? _rtjs_owned_string_free : nullptr);
+}
+
+static inline jerry_value_t _rtjs_external_string_to_js(const char *value, bool owned)
+{
+  return _rtjs_external_string_to_js(value, value ? strlen(value) : 0, owned);
+}
+
+template<typename View>
+static inline jerry_value_t _rtjs_external_string_to_js(const View &value, bool owned)
+{
+  return _rtjs_external_string_to_js(value.data(), value.size(), owned);
+}
+
@@ -5,4 +5,11 @@ void __rtjs_init_%1()
   jerry_value_t glob_obj = jerry_get_global_object();
 
   %2
+
+  jerry_release_value(glob_obj);
 }
+
+// the values __rtjs_init_%1() keeps for the bindings, call before jerry_cleanup()
+void __rtjs_cleanup_%1()
+{
+%3}
@@ -0,0 +1,12 @@
+static jerry_value_t %1_set(
+  const jerry_value_t function_obj,
+  const jerry_value_t this_val,
+  const jerry_value_t args[],
+  const jerry_length_t argc)
+{
+  RTJS_AUDIT_SCOPE("%1_set");
+  if (argc > 0)
+    %2 = %3;
+  return jerry_create_undefined();
+}
+
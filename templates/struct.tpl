@@ -0,0 +1,63 @@
+// struct %1
+static jerry_value_t _rtjs_%6_keys[%2];
+static jerry_value_t _rtjs_%6_view_proto;
+static void _rtjs_%6_view_free(void *ptr);
+static const jerry_object_native_info_t _rtjs_%6_view_info = { _rtjs_%6_view_free };
+
+// the memory stays owned by native code, only the wrapper is gone
+static void _rtjs_%6_view_free(void *ptr)
+{
+  rtjs::WrapperMap::instance().remove(ptr, &_rtjs_%6_view_info);
+}
+
+static jerry_value_t _rtjs_%6_to_js(const %1 &value)
+{
+  jerry_value_t obj = jerry_create_object();
+%3
+  return obj;
+}
+
+static %1 _rtjs_%6_from_js(const jerry_value_t obj)
+{
+  void *ptr = nullptr;
+  if (jerry_get_object_native_pointer(obj, &ptr, &_rtjs_%6_view_info))
+    return *static_cast<%1 *>(ptr); // a view, just copy the memory behind it
+
+  if (!jerry_value_is_object(obj))
+    throw std::string("struct %1 must be passed as object");
+
+  %1 value = %1();
+%4
+  return value;
+}
+
+static %1 *_rtjs_%6_this(const jerry_value_t this_val)
+{
+  void *ptr = nullptr;
+  if (!jerry_get_object_native_pointer(this_val, &ptr, &_rtjs_%6_view_info))
+    throw std::string("%1 accessor called on something else than a %1 view");
+  return static_cast<%1 *>(ptr);
+}
+
+%5
+// view on native memory, one per pointer while alive. the accessors on the shared prototype read and write the struct directly
+jerry_value_t _rtjs_%6_view(%1 *ptr)
+{
+  if (!ptr)
+    return jerry_create_null();
+
+  jerry_value_t obj;
+  if (_rtjs_find_wrapper((void *)ptr, &_rtjs_%6_view_info, obj))
+    return obj;
+
+  obj = _rtjs_new_wrapper((void *)ptr, &_rtjs_%6_view_info);
+  jerry_release_value(jerry_set_prototype(obj, _rtjs_%6_view_proto));
+  return obj;
+}
+
+// array of structs shared with scripts, to be read with a DataView using %6.size and %6.offsets
+jerry_value_t _rtjs_%6_array_buffer(%1 *ptr, size_t count)
+{
+  return jerry_create_arraybuffer_external((jerry_length_t)(count * sizeof(%1)), (uint8_t *)ptr, nullptr);
+}
+